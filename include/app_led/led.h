@@ -25,6 +25,49 @@ typedef struct {
 	(rgb_color_t){.r = ((_code) >> 16) & 0xFF, .g = ((_code) >> 8) & 0xFF, .b = (_code) & 0xFF}
 #define HEXRGB(_c) (((_c).r << 16) | ((_c).g << 8) | (_c).b)
 
+/* Fixed-point color helpers
+ *
+ * Integer only so the per-frame color path does not pull in soft-float on parts without an FPU.
+ * app_led_div255 is exact for v <= 255 * 255; app_led_grayscale is within 1 LSB of
+ * 0.299 * r + 0.587 * g + 0.114 * b.
+ */
+static inline uint8_t app_led_div255(uint16_t v)
+{
+	return (uint8_t)((v + 1U + (v >> 8)) >> 8);
+}
+
+/* Scale x by scale / 255 */
+static inline uint8_t app_led_scale8(uint8_t x, uint8_t scale)
+{
+	return app_led_div255((uint16_t)x * scale);
+}
+
+/* Weighted (luma) grayscale of a color; weights are 0.299/0.587/0.114 in 8.8 fixed-point */
+static inline uint8_t app_led_grayscale(rgb_color_t c)
+{
+	return (uint8_t)((77U * c.r + 150U * c.g + 29U * c.b) >> 8);
+}
+
+/* Step per tick to move from brightness to target in steps ticks, rounded up so target is reached
+ */
+static inline uint8_t app_led_fade_step(uint8_t from, uint8_t to, uint8_t steps)
+{
+	uint8_t diff = from > to ? from - to : to - from;
+
+	return (uint8_t)((diff + steps - 1U) / steps);
+}
+
+/* Fraction of an interpolation in 16.16 fixed-point, APP_LED_FRAC_ONE is the end */
+#define APP_LED_FRAC_ONE (1U << 16)
+
+/* Interpolate from a to b by frac / APP_LED_FRAC_ONE, rounded; exact at both ends */
+static inline uint8_t app_led_lerp8(uint8_t a, uint8_t b, uint32_t frac)
+{
+	uint32_t v = (uint32_t)a * (APP_LED_FRAC_ONE - frac) + (uint32_t)b * frac;
+
+	return (uint8_t)((v + APP_LED_FRAC_ONE / 2U) >> 16);
+}
+
 /* Predefined RGB colors - from FastLED */
 typedef enum {
 	AliceBlue = 0xF0F8FF,		 ///< @htmlcolorblock{F0F8FF}
@@ -203,23 +246,73 @@ struct led_gpio_config {
 	const struct gpio_dt_spec *led;
 };
 
+/* GPIO port driving pins of an App LED instance, grouped by app_led_init so each commit is a
+ * single masked write per port
+ */
+struct app_led_gpio_port {
+	const struct device *port; // GPIO controller
+	uint32_t mask;		   // pins on port to write this commit
+	uint32_t value;		   // levels of the pins in mask
+#if IS_ENABLED(CONFIG_APP_LED_GPIO_BCM)
+	uint32_t pins; // all pins of the instance on port
+	uint32_t planes[CONFIG_APP_LED_GPIO_BCM_BITS]; // pin levels for each brightness bit
+#endif
+};
+
 /* struct to hold state of each LED */
 struct app_led_state {
-	rgb_color_t color;	   // desired color
-	rgb_color_t _color;	   // actual color set - different for fade/blink check etc
+	rgb_color_t color; // desired color
+#if !IS_ENABLED(CONFIG_APP_LED_SINGLE_STORE)
+	rgb_color_t _color; // actual color set - different for fade/blink check etc
+#endif
+};
+
+/* blink timers of an LED, kept apart from app_led_state so they can be left out */
+struct app_led_blink {
 	uint32_t on_time_ms_left;  // time left on for blink
 	uint32_t off_time_ms_left; // time left off for blink
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	rgb_color_t color; // blink colour, the state colour is the base layer under it
+#endif
 };
 
-/* struct to hold sequence data */
+/* struct to hold sequence data
+ *
+ * Steps are timed from step_start and step_ms; the fade_step and time_sequence_next fields of the
+ * per update stepping were removed when sequences became time based.
+ */
 typedef struct {
-	uint16_t count;	    // counter for sequence
-	rgb_color_t color;  // color to set at this step
-	uint8_t brightness; // brightness to set at this step
-	uint8_t fade_step;  // fade step for inc/dec of brightness
-	int64_t last_tick;  // last tick for sequence timing
+	uint16_t count;		 // counter for sequence
+	rgb_color_t color;	 // color to set at this step
+	uint8_t brightness;	 // brightness to set at this step
+	int64_t last_tick;	 // last tick for sequence timing
+	int64_t step_start;	 // uptime the current step started, steps start when the last is due
+	uint32_t step_ms;	 // duration of the current step
+	int64_t pass_start;	 // uptime the current pass of the sequence started
+	rgb_color_t from;	 // color at the start of the step
+	rgb_color_t to;		 // color at the end of the step
+	uint8_t from_brightness; // brightness at the start of the step
+	uint8_t to_brightness;	 // brightness at the end of the step
 } app_led_sequence_data_t;
 
+/* struct to hold runtime counters of an App LED instance */
+struct app_led_stats {
+	uint32_t flushes;	     // strip flushes sent to the driver
+	uint32_t skipped_flushes;    // strip flushes skipped because no pixel changed
+	uint32_t last_late_ms;	     // how late the last workqueue update ran after its deadline
+	uint32_t max_late_ms;	     // worst workqueue update lateness seen
+	uint32_t cmds_processed;     // queued commands applied by the update
+	atomic_t cmds_dropped;	     // commands rejected because the queue was full
+	uint32_t hw_writes;	     // GPIO port/PWM channel writes issued to the driver
+	uint32_t hw_writes_elided;   // GPIO/PWM channel writes skipped as level already set
+	uint32_t bcm_isr_count;	     // GPIO BCM bit plane interrupts
+	uint64_t bcm_isr_cycles;     // cycles spent in GPIO BCM bit plane interrupts
+	uint32_t bcm_isr_max_cycles; // longest GPIO BCM bit plane interrupt
+	uint32_t update_count;	     // app_led_update frames run
+	uint32_t last_update_cycles; // cycles spent in the last app_led_update frame
+	uint32_t max_update_cycles;  // longest app_led_update frame
+};
+
 /* sequence function pointer type */
 typedef void (*app_led_sequence_func_t)(void *const leds, const void *const step,
 					k_timeout_t block);
@@ -234,45 +327,307 @@ typedef struct {
 	uint8_t decay_rate;	     // rate to decay brightness 0xFF for no decay
 } app_led_sequence_step_t;
 
-// TODO not used yet but might make different hardwares easier to support
-// typedef int (*app_led_update_hw_func_t)(void *leds);
-// typedef int (*app_led_set_pixels_func_t)(void *leds, uint16_t start, uint16_t end, rgb_color_t c,
-// 					 uint8_t brightness, k_timeout_t block);
-// struct app_led_funcs {
-// 	app_led_update_hw_func_t update_hw;   // function to update hardware
-// 	app_led_set_pixels_func_t set_pixels; // function to set pixels
-// };
+/* duration_ms of the last keyframe, which is held when the sequence ends or repeats */
+#define APP_LED_KEYFRAME_END UINT32_MAX
 
-/* Main struct for controllable app_led device */
+/* struct to hold a keyframe; color and brightness are interpolated from this keyframe to the next
+ * by the time since it started, so the animation speed does not depend on the update rate
+ */
 typedef struct {
+	rgb_color_t color;    // color at the start of the keyframe
+	uint32_t duration_ms; // time to reach the next keyframe, APP_LED_KEYFRAME_END for the last
+	uint8_t brightness;   // brightness at the start of the keyframe
+} app_led_keyframe_t;
+
+/* Layers composited bottom to top each update with CONFIG_APP_LED_LAYERS */
+enum app_led_layer {
+	APP_LED_LAYER_BASE,	// Manual colour or Rainbow
+	APP_LED_LAYER_SEQUENCE, // running sequence or keyframes
+	APP_LED_LAYER_BLINK,	// LEDs in their blink on period, others show through
+	APP_LED_LAYER_ERROR,	// error indicator
+	APP_LED_NUM_LAYERS,
+};
+
+/* How a layer is combined with the layers below it */
+enum app_led_blend_mode {
+	APP_LED_BLEND_NORMAL,  // mix by alpha
+	APP_LED_BLEND_ADD,     // add scaled by alpha, saturating
+	APP_LED_BLEND_LIGHTEN, // lighter of each channel scaled by alpha
+};
+
+/* Alpha and blend mode of a layer */
+struct app_led_layer_cfg {
+	uint8_t alpha; // 0 hides the layer, 0xFF is opaque
+	uint8_t blend; // enum app_led_blend_mode
+};
+
+/* Sequence cache entries for a sequence lasting _ms: one per update period plus the last step */
+#define APP_LED_SEQUENCE_CACHE_LEN(_ms) (DIV_ROUND_UP((_ms), CONFIG_APP_LED_UPDATE_PERIOD) + 1)
+
+struct app_led_data;
+struct app_led_strip;
+
+/* Colour after c in a span whose colours are stride bytes apart, so a span can walk an array of
+ * colours (stride sizeof(rgb_color_t)) or the colour member of an array of structs
+ */
+static inline const rgb_color_t *app_led_span_next(const rgb_color_t *c, size_t stride)
+{
+	return (const rgb_color_t *)((const uint8_t *)c + stride);
+}
+
+/* Hardware backend of an App LED instance, bound at compile time by APP_LED_STATIC_DEFINE from
+ * the devicetree compat. Out of tree backends can be bound with APP_LED_STATIC_FUNCS_DEFINE.
+ *
+ * Every hook except flush is called with the instance mutex held. A frame is begin_frame, one or
+ * more write_span and then commit if the dirty span is not empty.
+ */
+struct app_led_funcs {
+	/* Optional, called once from app_led_init */
+	int (*init)(struct app_led_data *leds);
+	/* Optional, called before pixels of a frame are written */
+	void (*begin_frame)(struct app_led_data *leds);
+	/* Render logical pixels [start, end) from c, advancing c by stride bytes with
+	 * app_led_span_next (0 fills with *c), scaled by brightness. Should mark changed pixels
+	 * with app_led_mark_dirty.
+	 */
+	int (*write_span)(struct app_led_data *leds, uint16_t start, uint16_t end,
+			  const rgb_color_t *c, size_t stride, uint8_t brightness);
+	/* Write the dirty span to the hardware, or arrange for flush to */
+	int (*commit)(struct app_led_data *leds);
+	/* Optional, called from the update work without the mutex held for slow transfers */
+	void (*flush)(struct app_led_data *leds);
+};
+
+/* Built in backends */
+extern const struct app_led_funcs app_led_strip_funcs;
+extern const struct app_led_funcs app_led_pwm_funcs;
+extern const struct app_led_funcs app_led_gpio_funcs;
+extern const struct app_led_funcs app_led_strip_palette_funcs;
+extern const struct app_led_funcs app_led_strip_segment_funcs;
+
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE)
+/* Palette entries and packed index frame bytes of a palette strip */
+#define APP_LED_PALETTE_SIZE BIT(CONFIG_APP_LED_STRIP_PALETTE_BITS)
+#define APP_LED_PALETTE_FRAME_SIZE(_num_leds)                                                      \
+	DIV_ROUND_UP((_num_leds) * CONFIG_APP_LED_STRIP_PALETTE_BITS, 8)
+#endif
+
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS)
+/* Physical strip shared by segment views; each view renders into the back buffer here and one flush
+ * sends the strip however many views changed
+ */
+struct app_led_strip {
+	const struct device *const dev; // LED strip device
+	struct k_mutex mutex;		// guards buffers and dirty span, taken inside a view mutex
+	void *const pixels[2];		// front/back led_rgb buffers
+	atomic_t front;			// index of pixels[] being flushed, other is back
+	const uint16_t num_leds;	// chain length of the strip
+	uint16_t dirty_start;		// first pixel changed since last flush
+	uint16_t dirty_end;		// one past last changed pixel, 0 if clean
+	int64_t last_flush;		// uptime of last flush
+	uint32_t flushes;		// flushes sent to the driver
+	uint32_t skipped_flushes;	// flushes skipped because no pixel changed
+	bool initialized;		// set up by the first view app_led_init
+#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
+	struct k_work flush_work; // queued by view updates so runs once after them
+#endif
+};
+#endif
+
+/* Completion flags passed to app_led_done_cb_t */
+#define APP_LED_DONE_SEQUENCE BIT(0) // sequence finished or was cleared
+#define APP_LED_DONE_BLINK    BIT(1) // last blink off period ended
+
+/* Commands that can be queued with app_led_cmd_push */
+enum app_led_cmd_type {
+	APP_LED_CMD_SET_COLOR,	// app_led_set_global_color
+	APP_LED_CMD_SET_INDEX,	// app_led_set_index
+	APP_LED_CMD_BLINK,	// app_led_blink
+	APP_LED_CMD_SEQUENCE,	// app_led_run_sequence
+	APP_LED_CMD_BRIGHTNESS, // app_led_set_global_brightness
+};
+
+/* struct to hold a queued command, only the member for type is used */
+struct app_led_cmd {
+	enum app_led_cmd_type type;
+	union {
+		struct {
+			uint16_t index;	   // LED index for APP_LED_CMD_SET_INDEX
+			rgb_color_t color; // color to set
+		} set;
+		struct {
+			rgb_color_t color;   // color to blink
+			uint32_t on_ms;	     // on period
+			uint32_t off_ms;     // off period
+			bool state_override; // override current blink state
+		} blink;
+		struct {
+			const app_led_sequence_step_t *steps; // sequence to run
+			int8_t num_repeat;		      // -1 for infinite
+		} sequence;
+		uint8_t brightness; // global brightness to set
+	};
+};
+
+/* Command ring slot; seq is the ring position the slot is next ready to be written (seq == pos)
+ * or read (seq == pos + 1) at
+ */
+struct app_led_cmd_slot {
+	atomic_t seq;
+	struct app_led_cmd cmd;
+};
+
+/* Called when a sequence or blink completes, from the context that ended it (usually the update
+ * work) so must not block. It is called without the instance mutex held so may use the API.
+ */
+typedef void (*app_led_done_cb_t)(struct app_led_data *leds, uint32_t done, void *user_data);
+
+/* Main struct for controllable app_led device */
+typedef struct app_led_data {
 	LedMode mode;			    // current display mode
 	LedMode last_mode;		    // last mode before current to return
 	const LedType hw_type;		    // tagged hardware type for any runtime checks
+	const struct app_led_funcs *const funcs; // hardware backend
 	const bool is_rgb;		    // true if RGB LED strip
-	const uint8_t offset;		    // start offset to apply to device tree node phandle
+	const uint16_t offset;		    // start offset to apply to device tree node phandle
 	const uint8_t cell_size;            // number of LEDs in an addressable index
 	struct k_mutex mutex;		    // mutex for mutli-thread access
+	struct k_condvar done;		    // broadcast on mode change for app_led_wait_x()
+	app_led_done_cb_t done_cb;	    // optional sequence/blink completion callback
+	void *done_cb_user_data;	    // user data for done_cb
+	uint32_t done_pending;		    // APP_LED_DONE_x not yet passed to done_cb
 	const struct device *const app_led; // pointer to device tree node
 	uint8_t global_brightness;	    // current brightness
 	uint8_t hue;			    // global hue for rainbow
 	bool rainbow;			    // rainbow mode
-	const uint8_t hw_num_leds;	    // number of LEDs in DT prop
-	const uint8_t num_leds;		    // number of LEDs in sequence
+	const uint16_t hw_num_leds;	    // number of LEDs in DT prop
+	const uint16_t num_leds;	    // number of LEDs in sequence
 	rgb_color_t global_color;	    // user colour for manual mode, will revert to this
 	rgb_color_t _color;		    // current global color
         bool _toggle;		            // toggle state for blink
 	struct app_led_state *const state;  // state of each led
-	uint8_t sequence_step;		    // sequence step index
+	struct app_led_blink *const blink;  // blink timers of each led, NULL without APP_LED_BLINK
+	uint16_t sequence_step;		    // sequence step index
 	const app_led_sequence_step_t *sequence; // current sequence frame
-	uint32_t time_sequence_next;		 // tick to next
+	const app_led_keyframe_t *keyframes;	 // current keyframe sequence, used if sequence is NULL
+	app_led_keyframe_t fade[2];		 // keyframes of the app_led_fade_to fade
 	int8_t sequence_repeat_count;		 // -1 to repeat forever
 	app_led_sequence_data_t sequence_data;	 // data for sequence being run
-	void *const pixels;			 // pixel buffer for RGB LED strip, NULL if not used
+#if IS_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE)
+	rgb_color_t *sequence_cache;  // caller buffer of pre-rendered colours, NULL if not set
+	uint16_t sequence_cache_size; // entries in sequence_cache
+	uint16_t sequence_cache_len;  // entries rendered for the running sequence, 0 if not cached
+	uint32_t sequence_cache_ms;   // length of one pass of the cached sequence
+	rgb_color_t cache_color;      // global colour the cache was rendered with
+	uint8_t cache_brightness;     // global brightness the cache was rendered with
+#endif
+	void *const pixels[2];			 // front/back pixel buffers for strip, NULL if not used
+	atomic_t front;				 // index of pixels[] being flushed, other is back
+	uint8_t *const channels;		 // pin channel frame being rendered, NULL for strip
+	uint32_t *const hw_shadow;		 // last driver level written per pin channel
+	struct app_led_gpio_port *const gpio_ports; // ports of GPIO instance pins, NULL otherwise
+	uint8_t num_gpio_ports;			    // entries of gpio_ports in use
+#if IS_ENABLED(CONFIG_APP_LED_GPIO_BCM)
+	struct k_timer bcm_timer;   // steps the GPIO bit planes
+	struct k_spinlock bcm_lock; // guards gpio_ports planes against bcm_timer
+	uint8_t bcm_plane;	    // bit plane shown next
+	bool bcm_running;	    // bcm_timer started
+#endif
+	bool in_update;				 // frame batched by app_led_update, commit deferred
+	uint16_t dirty_start;			 // first pixel/channel changed since last flush/commit
+	uint16_t dirty_end;			 // one past last changed pixel/channel, 0 if clean
+	int64_t last_flush;			 // uptime of last strip flush
+	struct app_led_stats stats;		 // runtime counters
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE)
+	uint8_t *const palette_frame; // packed palette index of each pixel, NULL if not a palette strip
+	rgb_color_t *const palette;   // palette colours before brightness and gamma
+	uint16_t palette_len;	      // palette entries in use
+	uint16_t palette_fixed;	      // entries set by app_led_palette_set, never reclaimed
+	bool palette_reclaimed;	      // full palette already reclaimed this frame
+	uint8_t palette_brightness;   // brightness of the last write, applied at flush
+#endif
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS)
+	struct app_led_strip *const strip; // shared strip of a segment view at offset, NULL otherwise
+#endif
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	rgb_color_t *const layer_frame; // layers composited at brightness before the backend write
+	struct app_led_layer_cfg layers[APP_LED_NUM_LAYERS]; // alpha and blend of each layer
+	uint8_t layers_active;				     // BIT(app_led_layer) of layers shown
+	int8_t layer; // layer app_led_update is compositing, -1 when writing to the backend
+#endif
+#if IS_ENABLED(CONFIG_APP_LED_BRIGHTNESS_LUT)
+	uint8_t scale_lut[256];	      // channel value scaled by scale_lut_brightness
+	uint8_t scale_lut_brightness; // brightness scale_lut was built for; zeroed table is valid for 0
+#endif
+	bool initialized; // set by app_led_init, shared work skips instances until then
+#if IS_ENABLED(CONFIG_APP_LED_CMD_QUEUE)
+	struct app_led_cmd_slot cmd_ring[CONFIG_APP_LED_CMD_QUEUE_SIZE]; // queued commands
+	atomic_t cmd_tail; // next ring position for producers to claim
+	uint32_t cmd_head; // next ring position for the update to apply
+#endif
 #if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
+	int64_t next_change; // uptime the state machine is next due an update
+	atomic_t wake;	     // set from any context for the work to update now
+#endif
+#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE) && !IS_ENABLED(CONFIG_APP_LED_SHARED_WORK)
 	struct k_work_delayable dwork; // delayed work for state machine update
+	int64_t next_update;	       // uptime dwork is due, to measure lateness
 #endif
 } app_led_data_t;
 
+/* Instances are placed in an iterable section when the shared work updates them all */
+#if IS_ENABLED(CONFIG_APP_LED_SHARED_WORK)
+#define APP_LED_DATA_DEFINE(_name) STRUCT_SECTION_ITERABLE(app_led_data, _name)
+#else
+#define APP_LED_DATA_DEFINE(_name) app_led_data_t _name
+#endif
+
+/* Scale a color by brightness
+ *
+ * Uses the cached table if scaling by the brightness it was built for, which is the global
+ * brightness outside of sequence fades.
+ */
+static inline rgb_color_t app_led_scale_color(const app_led_data_t *leds, rgb_color_t c,
+					      uint8_t brightness)
+{
+#if IS_ENABLED(CONFIG_APP_LED_BRIGHTNESS_LUT)
+	if (brightness == leds->scale_lut_brightness) {
+		c.r = leds->scale_lut[c.r];
+		c.g = leds->scale_lut[c.g];
+		c.b = leds->scale_lut[c.b];
+		return c;
+	}
+#endif
+	c.r = app_led_scale8(c.r, brightness);
+	c.g = app_led_scale8(c.g, brightness);
+	c.b = app_led_scale8(c.b, brightness);
+
+	return c;
+}
+
+/* Extend the dirty span to include pixel or channel i; call with mutex held */
+static inline void app_led_mark_dirty(app_led_data_t *leds, uint16_t i)
+{
+	if (leds->dirty_end == 0 || i < leds->dirty_start) {
+		leds->dirty_start = i;
+	}
+	leds->dirty_end = MAX(leds->dirty_end, i + 1);
+}
+
+/* Hardware type of a devicetree node by compat as a constant expression, strip if not pwm-leds or
+ * gpio-leds
+ */
+#define APP_LED_DT_HW_TYPE(_node_id)                                                               \
+	COND_CODE_1(DT_NODE_HAS_COMPAT(_node_id, pwm_leds), (APP_LED_TYPE_PWM),                    \
+		    (COND_CODE_1(DT_NODE_HAS_COMPAT(_node_id, gpio_leds), (APP_LED_TYPE_GPIO),     \
+				 (APP_LED_TYPE_STRIP))))
+
+/* Backend funcs for a devicetree node by compat, strip if not pwm-leds or gpio-leds */
+#define APP_LED_DT_FUNCS(_node_id)                                                                 \
+	COND_CODE_1(DT_NODE_HAS_COMPAT(_node_id, pwm_leds), (&app_led_pwm_funcs),                  \
+		    (COND_CODE_1(DT_NODE_HAS_COMPAT(_node_id, gpio_leds), (&app_led_gpio_funcs),   \
+				 (&app_led_strip_funcs))))
+
 /* Helper to calculate the number of logical LEDs in a chain; if it's not a strip LED and is RGB,
  * divide by 3
  */
@@ -280,36 +635,62 @@ typedef struct {
 	COND_CODE_1(DT_NODE_HAS_PROP(_node_id, chain_length), (_num_leds),                         \
 		    ((_is_rgb) ? (_num_leds) / 3U : _num_leds))
 
-/**
- * @brief Statically define and initialize an app_led_data instance with type info.
- *
- * @param _name Name of the app_led_data variable.
- * @param _node_id Devicetree node identifier for the underlying device (GPIO, PWM, SPI, etc.).
- * @param _num_hw_leds The total number of physical LEDs/pixels/components.
- * @param _is_rgb A compile-time constant (0 or 1). If non-zero, indicates logical RGB.
+/* Strip storage of each instance layout: frame is a front and back led_rgb buffer, palette a packed
+ * index frame and palette expanded into one led_rgb buffer at flush and segment nothing, as it
+ * renders into the buffers of a shared app_led_strip
  */
-#define APP_LED_STATIC_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb)                              \
-	/* Auto-detect hardware type based on known compat */                                      \
-	static const LedType _name##_auto_hw_type = /* PWM type */                                 \
-		COND_CODE_1(                                                                       \
-			DT_NODE_HAS_COMPAT(_node_id, pwm_leds), (APP_LED_TYPE_PWM),                \
-			(/* GPIO type */                                                           \
-			 COND_CODE_1(DT_NODE_HAS_COMPAT(_node_id, gpio_leds), (APP_LED_TYPE_GPIO), \
-				     (/* Fallback to strip type */                                 \
-				      APP_LED_TYPE_STRIP))));                                      \
+#define APP_LED_STRIP_BUFFERS_frame(_name, _num_leds)                                              \
+	static struct led_rgb _name##_pixel_buffer[2][(_num_leds)];
+#define APP_LED_STRIP_BUFFERS_palette(_name, _num_leds)                                            \
+	static struct led_rgb _name##_pixel_buffer[1][(_num_leds)];                                \
+	static uint8_t _name##_palette_frame[APP_LED_PALETTE_FRAME_SIZE(_num_leds)];               \
+	static rgb_color_t _name##_palette[APP_LED_PALETTE_SIZE];
+#define APP_LED_STRIP_BUFFERS_segment(_name, _num_leds)
+#define APP_LED_STRIP_PIXELS_frame(_name)   {_name##_pixel_buffer[0], _name##_pixel_buffer[1]}
+#define APP_LED_STRIP_PIXELS_palette(_name) {_name##_pixel_buffer[0], NULL}
+#define APP_LED_STRIP_PIXELS_segment(_name) {NULL, NULL}
+#define APP_LED_STRIP_PALETTE_frame(_name)   .palette_frame = NULL, .palette = NULL,
+#define APP_LED_STRIP_PALETTE_palette(_name)                                                       \
+	.palette_frame = _name##_palette_frame, .palette = _name##_palette,
+#define APP_LED_STRIP_PALETTE_segment(_name) .palette_frame = NULL, .palette = NULL,
+
+/* Internal: define an instance and its buffers; _layout is frame, palette or segment (see
+ * APP_LED_STRIP_BUFFERS_x) for strips, frame otherwise. _strip is the shared app_led_strip of a
+ * segment, NULL otherwise, and _offset the first LED of the node the instance drives
+ */
+#define APP_LED_STATIC_LAYOUT_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb, _funcs, _layout,      \
+					     _strip, _offset)                                      \
+	BUILD_ASSERT((_num_hw_leds) <= UINT16_MAX, "App LED instances are limited to 65535 LEDs"); \
 	static struct app_led_state _name##_state_array[APP_LED_CALC_NUM_LOGICAL_LEDS(             \
 		_node_id, _num_hw_leds, _is_rgb)] = {0};                                           \
-	COND_CODE_1(DT_NODE_HAS_PROP(_node_id, chain_length),                                      \
-		    (static struct led_rgb _name##_pixel_buffer[(_num_hw_leds)] = {0};),           \
-		    (static void *const _name##_pixel_buffer = NULL;))                             \
-	app_led_data_t _name = {                                                                   \
+	IF_ENABLED(CONFIG_APP_LED_BLINK,                                                           \
+		   (static struct app_led_blink _name##_blink_array[APP_LED_CALC_NUM_LOGICAL_LEDS( \
+			    _node_id, _num_hw_leds, _is_rgb)] = {0};))                             \
+	/* Strip instances get a front buffer for the flush and back buffer for writers */         \
+	IF_ENABLED(DT_NODE_HAS_PROP(_node_id, chain_length),                                       \
+		   (APP_LED_STRIP_BUFFERS_##_layout(_name, _num_hw_leds)))                         \
+	/* GPIO/PWM instances render channels into a frame committed once per update */            \
+	IF_DISABLED(DT_NODE_HAS_PROP(_node_id, chain_length),                                      \
+		    (static uint8_t _name##_channels[(_num_hw_leds)] = {0};                        \
+		     static uint32_t _name##_hw_shadow[(_num_hw_leds)];))                          \
+	IF_ENABLED(CONFIG_APP_LED_LAYERS,                                                          \
+		   (static rgb_color_t _name##_layer_frame[APP_LED_CALC_NUM_LOGICAL_LEDS(          \
+			    _node_id, _num_hw_leds, _is_rgb)];))                                   \
+	/* at most one port per pin, grouped at init */                                            \
+	IF_ENABLED(DT_NODE_HAS_COMPAT(_node_id, gpio_leds),                                        \
+		   (static struct app_led_gpio_port _name##_gpio_ports[(_num_hw_leds)];))          \
+	APP_LED_DATA_DEFINE(_name) = {                                                             \
 		.mode = Manual,                                                                    \
 		.last_mode = Manual,                                                               \
 		.mutex = Z_MUTEX_INITIALIZER(_name.mutex),                                         \
+		.done = Z_CONDVAR_INITIALIZER(_name.done),                                         \
+		.done_cb = NULL,                                                                   \
+		.done_pending = 0,                                                                 \
 		.app_led = DEVICE_DT_GET(_node_id),                                                \
-		.hw_type = (_name##_auto_hw_type),                                                 \
+		.hw_type = APP_LED_DT_HW_TYPE(_node_id),                                           \
+		.funcs = (_funcs),                                                                 \
 		.is_rgb = (bool)(_is_rgb),                                                         \
-		.offset = 0,                                                                       \
+		.offset = (_offset),                                                               \
 		/* TODO */                                                                         \
 		.cell_size = 1,                                                                    \
 		.hw_num_leds = (_num_hw_leds),                                                     \
@@ -321,14 +702,69 @@ typedef struct {
 		.hue = 0,                                                                          \
 		.rainbow = false,                                                                  \
 		.state = _name##_state_array,                                                      \
+		.blink = COND_CODE_1(CONFIG_APP_LED_BLINK, (_name##_blink_array), (NULL)),         \
 		.sequence_step = 0,                                                                \
 		.sequence = NULL,                                                                  \
-		.time_sequence_next = 0,                                                           \
+		.keyframes = NULL,                                                                 \
 		.sequence_repeat_count = 0,                                                        \
 		.sequence_data = {0},                                                              \
-		.pixels = _name##_pixel_buffer,                                                    \
+		IF_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE,                                          \
+			   (.sequence_cache = NULL, .sequence_cache_size = 0,                      \
+			    .sequence_cache_len = 0,))                                             \
+		.pixels = COND_CODE_1(DT_NODE_HAS_PROP(_node_id, chain_length),                    \
+				      (APP_LED_STRIP_PIXELS_##_layout(_name)), ({NULL, NULL})),    \
+		.front = ATOMIC_INIT(0),                                                           \
+		.channels = COND_CODE_1(DT_NODE_HAS_PROP(_node_id, chain_length), (NULL),          \
+					(_name##_channels)),                                       \
+		.hw_shadow = COND_CODE_1(DT_NODE_HAS_PROP(_node_id, chain_length), (NULL),         \
+					 (_name##_hw_shadow)),                                     \
+		.gpio_ports = COND_CODE_1(DT_NODE_HAS_COMPAT(_node_id, gpio_leds),                 \
+					  (_name##_gpio_ports), (NULL)),                           \
+		.num_gpio_ports = 0,                                                               \
+		.in_update = false,                                                                \
+		/* whole strip/all channels dirty so first flush/commit clears it */               \
+		.dirty_start = 0,                                                                  \
+		.dirty_end = (_num_hw_leds),                                                       \
+		.last_flush = 0,                                                                   \
+		.stats = {0},                                                                      \
+		IF_ENABLED(CONFIG_APP_LED_STRIP_PALETTE,                                           \
+			   (APP_LED_STRIP_PALETTE_##_layout(_name) .palette_len = 0,               \
+			    .palette_fixed = 0, .palette_reclaimed = false,                        \
+			    .palette_brightness = 0xFF,))                                          \
+		IF_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS, (.strip = (_strip),))                    \
+		IF_ENABLED(CONFIG_APP_LED_LAYERS,                                                  \
+			   (.layer_frame = _name##_layer_frame,                                    \
+			    .layers = {[0 ... APP_LED_NUM_LAYERS - 1] = {.alpha = 0xFF}},          \
+			    .layers_active = BIT(APP_LED_LAYER_BASE), .layer = -1,))               \
+		.initialized = false,                                                              \
 	}
 
+/**
+ * @brief Statically define and initialize an app_led_data instance with a given backend.
+ *
+ * @param _name Name of the app_led_data variable.
+ * @param _node_id Devicetree node identifier for the underlying device (GPIO, PWM, SPI, etc.).
+ * @param _num_hw_leds The total number of physical LEDs/pixels/components.
+ * @param _is_rgb A compile-time constant (0 or 1). If non-zero, indicates logical RGB.
+ * @param _funcs Pointer to the struct app_led_funcs backend.
+ */
+#define APP_LED_STATIC_FUNCS_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb, _funcs)                \
+	APP_LED_STATIC_LAYOUT_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb, _funcs, frame, NULL, 0)
+
+/**
+ * @brief Statically define and initialize an app_led_data instance with type info.
+ *
+ * The backend is chosen from the devicetree compat of _node_id.
+ *
+ * @param _name Name of the app_led_data variable.
+ * @param _node_id Devicetree node identifier for the underlying device (GPIO, PWM, SPI, etc.).
+ * @param _num_hw_leds The total number of physical LEDs/pixels/components.
+ * @param _is_rgb A compile-time constant (0 or 1). If non-zero, indicates logical RGB.
+ */
+#define APP_LED_STATIC_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb)                              \
+	APP_LED_STATIC_FUNCS_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb,                        \
+				    APP_LED_DT_FUNCS(_node_id))
+
 /* Helper to define a static discrete App LED chain of GPIO or PWM LEDs */
 #define APP_LED_STATIC_IDV_DEFINE(_name, _node_id)                                                 \
 	BUILD_ASSERT(DT_NODE_HAS_COMPAT(_node_id, gpio_leds) ||                                    \
@@ -345,10 +781,50 @@ typedef struct {
 #define APP_LED_STATIC_STRIP_DEFINE(_name, _node_id)                                               \
 	BUILD_ASSERT(IS_ENABLED(CONFIG_LED_STRIP), "CONFIG_LED_STRIP must be enabled");            \
 	APP_LED_STATIC_DEFINE(_name, _node_id, DT_PROP(_node_id, chain_length), 1)
-/* Helper to define a App LED with a offset for node LED array */
+/* Helper to define a palette indexed App LED strip; pixels hold a CONFIG_APP_LED_STRIP_PALETTE_BITS
+ * index into a per instance palette rather than a colour
+ */
+#define APP_LED_STATIC_STRIP_PALETTE_DEFINE(_name, _node_id)                                       \
+	BUILD_ASSERT(IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE),                                     \
+		     "CONFIG_APP_LED_STRIP_PALETTE must be enabled");                              \
+	APP_LED_STATIC_LAYOUT_DEFINE(_name, _node_id, DT_PROP(_node_id, chain_length), 1,          \
+				     &app_led_strip_palette_funcs, palette, NULL, 0)
+/* Helper to define a strip shared by segment views using the chain_length property */
+#define APP_LED_STRIP_SHARED_DEFINE(_name, _node_id)                                               \
+	BUILD_ASSERT(IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS),                                    \
+		     "CONFIG_APP_LED_STRIP_SEGMENTS must be enabled");                             \
+	static struct led_rgb _name##_pixel_buffer[2][DT_PROP(_node_id, chain_length)];            \
+	struct app_led_strip _name = {                                                             \
+		.dev = DEVICE_DT_GET(_node_id),                                                    \
+		.mutex = Z_MUTEX_INITIALIZER(_name.mutex),                                         \
+		.pixels = {_name##_pixel_buffer[0], _name##_pixel_buffer[1]},                      \
+		.front = ATOMIC_INIT(0),                                                           \
+		.num_leds = DT_PROP(_node_id, chain_length),                                       \
+		/* whole strip dirty so the first flush clears it */                               \
+		.dirty_start = 0,                                                                  \
+		.dirty_end = DT_PROP(_node_id, chain_length),                                      \
+		.last_flush = 0,                                                                   \
+		.initialized = false,                                                              \
+	}
+/* Helper to define a segment view of LEDs [_start, _start + _len) of a strip shared with
+ * APP_LED_STRIP_SHARED_DEFINE; the views render into the one strip buffer, which is flushed once
+ * however many of them changed
+ */
+#define APP_LED_STATIC_STRIP_SEGMENT_DEFINE(_name, _strip, _node_id, _start, _len)                 \
+	BUILD_ASSERT(IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS),                                    \
+		     "CONFIG_APP_LED_STRIP_SEGMENTS must be enabled");                             \
+	BUILD_ASSERT((_len) > 0 && (_start) + (_len) <= DT_PROP(_node_id, chain_length),           \
+		     #_name " must be within the strip");                                          \
+	APP_LED_STATIC_LAYOUT_DEFINE(_name, _node_id, _len, 1, &app_led_strip_segment_funcs,       \
+				     segment, &(_strip), _start)
+/* Helper to define a App LED with a offset for node LED array, GPIO or PWM only; strips are split
+ * with APP_LED_STATIC_STRIP_SEGMENT_DEFINE
+ */
 #define APP_LED_STATIC_OFFSET_DEFINE(_name, _node_id, _offset, _num_hw_leds, _is_rgb)              \
-	APP_LED_STATIC_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb);                             \
-	_name.offset = _offset
+	BUILD_ASSERT(!DT_NODE_HAS_PROP(_node_id, chain_length),                                    \
+		     #_node_id " is a strip, use APP_LED_STATIC_STRIP_SEGMENT_DEFINE");            \
+	APP_LED_STATIC_LAYOUT_DEFINE(_name, _node_id, _num_hw_leds, _is_rgb,                       \
+				     APP_LED_DT_FUNCS(_node_id), frame, NULL, _offset)
 
 /* @brief Run a LED sequence
  *
@@ -359,7 +835,33 @@ typedef struct {
  */
 void app_led_run_sequence(app_led_data_t *leds, const app_led_sequence_step_t *sequence,
 			  int8_t num_repeat, k_timeout_t block);
+/* @brief Run a keyframe sequence
+ *
+ * Replaces any running sequence. Each step fades from its keyframe to the next over duration_ms,
+ * timed from when the sequence started rather than by counting updates.
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param keyframes Keyframes to run, the last with duration_ms APP_LED_KEYFRAME_END
+ * @param num_repeat Number of times to repeat the sequence, -1 for infinite
+ * @param block Timeout for blocking operation
+ */
+void app_led_run_keyframes(app_led_data_t *leds, const app_led_keyframe_t *keyframes,
+			   int8_t num_repeat, k_timeout_t block);
 void app_led_sequence_clear(app_led_data_t *leds, k_timeout_t block);
+/* @brief Set the buffer app_led_run_sequence pre-renders sequences into
+ *
+ * With CONFIG_APP_LED_SEQUENCE_CACHE a step table whose steps have no step function, or only
+ * app_led_seq_fnc, is rendered once into cache and played back from it. Sequences that don't fit
+ * run as normal. Size with APP_LED_SEQUENCE_CACHE_LEN() of the longest sequence to be cached.
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param cache Buffer owned by the caller while set, NULL to stop caching
+ * @param len Entries in cache
+ * @param block Timeout for blocking operation
+ * @return 0 on success, -ENOTSUP without the sequence cache, -EBUSY if the lock timed out
+ */
+int app_led_set_sequence_cache(app_led_data_t *leds, rgb_color_t *cache, uint16_t len,
+			       k_timeout_t block);
 
 /* @brief Blink an LED at specific index
  *
@@ -389,10 +891,10 @@ int app_led_blink(app_led_data_t *leds, rgb_color_t c, uint32_t on_period_ms,
 int app_led_blink_sync_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_timeout_t block);
 int app_led_blink_sync(app_led_data_t *leds, rgb_color_t c, k_timeout_t block);
 
-/* @breif Fade to a color over a period of time
+/* @brief Fade to a color over a period of time
  *
- * Maniplates app_led_fade_sequence to set the color and brightness so will not work with multiple
- * App LEDs fading at once
+ * Runs as keyframes from the global color and brightness kept in leds, so any number of App LEDs
+ * can fade at once. The global color and brightness are set to the end of the fade.
  *
  * @param leds Pointer to the app_led_data_t structure
  * @param c Color to fade to
@@ -442,6 +944,17 @@ void app_led_wait_sequence(app_led_data_t *leds, k_timeout_t wait_ms);
  */
 void app_led_wait_blink(app_led_data_t *leds, k_timeout_t wait_ms);
 
+/* @brief Set a callback for sequence/blink completion
+ *
+ * Alternative to blocking a thread in app_led_wait_x(). The callback is called with
+ * APP_LED_DONE_SEQUENCE or APP_LED_DONE_BLINK when the instance leaves that mode.
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param cb Callback, NULL to remove
+ * @param user_data Passed to cb
+ */
+void app_led_set_done_callback(app_led_data_t *leds, app_led_done_cb_t cb, void *user_data);
+
 /* @brief Set the LED mode
  *
  * @param leds Pointer to the app_led_data_t structure
@@ -449,6 +962,31 @@ void app_led_wait_blink(app_led_data_t *leds, k_timeout_t wait_ms);
  * @param block Timeout for blocking operation
  */
 void app_led_set_mode(app_led_data_t *leds, LedMode mode, k_timeout_t block);
+/* @brief Return to the mode before the current one
+ *
+ * With CONFIG_APP_LED_LAYERS this is the top layer still active, an error layer being dropped.
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param block Timeout for blocking operation
+ */
+void app_led_last_mode(app_led_data_t *leds, k_timeout_t block);
+
+/* @brief Set the alpha and blend mode of a layer
+ *
+ * With CONFIG_APP_LED_LAYERS a sequence, blink or error is drawn over the layers below rather than
+ * replacing them; the mode is the top layer shown. Manual and Rainbow clear the layers above the
+ * base, Off blanks all of them until the next mode is set.
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param layer Layer to set
+ * @param alpha Opacity of the layer, 0 to hide it
+ * @param blend How the layer is combined with the layers below
+ * @param block Timeout for blocking operation
+ * @return 0 on success, -EINVAL for an unknown layer or blend, -ENOTSUP without layers, -EBUSY if
+ * the lock timed out
+ */
+int app_led_layer_set(app_led_data_t *leds, enum app_led_layer layer, uint8_t alpha,
+		      enum app_led_blend_mode blend, k_timeout_t block);
 
 /* @brief Set the color of a specific LED
  *
@@ -459,6 +997,84 @@ void app_led_set_mode(app_led_data_t *leds, LedMode mode, k_timeout_t block);
  * @return 0 on success, negative error code on failure
  */
 int app_led_set_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_timeout_t block);
+/* @brief Get the color an LED is showing, before gamma correction
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param i Index of the LED to read
+ * @param c Set to the color
+ * @return 0 on success, -EINVAL if i is out of range
+ */
+int app_led_get_pixel_rgb(const app_led_data_t *const leds, uint16_t i, rgb_color_t *c);
+/* @brief Set the color of a run of LEDs from an array
+ *
+ * Writes [start, start + n) under a single lock with a single commit to the hardware, rather
+ * than calling app_led_set_index for each pixel.
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param start Index of the first LED to set
+ * @param c Array of n colors to set
+ * @param n Number of LEDs to set
+ * @param block Timeout for blocking operation
+ * @return 0 on success, negative error code on failure
+ */
+int app_led_set_range(app_led_data_t *leds, uint16_t start, const rgb_color_t *c, uint16_t n,
+		      k_timeout_t block);
+/* @brief Fill a run of LEDs with one color
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param start Index of the first LED to set
+ * @param n Number of LEDs to set
+ * @param c Color to set
+ * @param block Timeout for blocking operation
+ * @return 0 on success, negative error code on failure
+ */
+int app_led_fill_range(app_led_data_t *leds, uint16_t start, uint16_t n, rgb_color_t c,
+		       k_timeout_t block);
+/* @brief Set palette entries of a palette strip
+ *
+ * Entries are kept as given, and in place when the palette is full. Pixels using them change
+ * colour on the next flush, shown at the global brightness until another write changes it.
+ *
+ * @param leds Pointer to a palette strip defined with APP_LED_STATIC_STRIP_PALETTE_DEFINE
+ * @param first First palette entry to set
+ * @param c Array of n colors
+ * @param n Number of entries to set
+ * @param block Timeout for blocking operation
+ * @return 0 on success, -ENOTSUP if not a palette strip, negative error code on failure
+ */
+int app_led_palette_set(app_led_data_t *leds, uint16_t first, const rgb_color_t *c, uint16_t n,
+			k_timeout_t block);
+/* @brief Rotate palette entries [first, first + n) of a palette strip down by one
+ *
+ * Every pixel using the entries shifts colour without being rewritten.
+ *
+ * @param leds Pointer to a palette strip defined with APP_LED_STATIC_STRIP_PALETTE_DEFINE
+ * @param first First palette entry to rotate
+ * @param n Number of entries to rotate
+ * @param block Timeout for blocking operation
+ * @return 0 on success, -ENOTSUP if not a palette strip, negative error code on failure
+ */
+int app_led_palette_rotate(app_led_data_t *leds, uint16_t first, uint16_t n, k_timeout_t block);
+/* @brief Fill a run of LEDs of a palette strip with a palette entry
+ *
+ * @param leds Pointer to a palette strip defined with APP_LED_STATIC_STRIP_PALETTE_DEFINE
+ * @param start Index of the first LED to set
+ * @param n Number of LEDs to set
+ * @param index Palette entry to set
+ * @param block Timeout for blocking operation
+ * @return 0 on success, -ENOTSUP if not a palette strip, negative error code on failure
+ */
+int app_led_fill_palette_range(app_led_data_t *leds, uint16_t start, uint16_t n, uint8_t index,
+			       k_timeout_t block);
+/* @brief Send the pixels the segment views of a shared strip changed to the strip
+ *
+ * The update work does this once after the views have updated, so it is only needed without
+ * CONFIG_APP_LED_USE_WORKQUEUE, after calling app_led_update on each view.
+ *
+ * @param strip Pointer to a strip defined with APP_LED_STRIP_SHARED_DEFINE
+ * @return 0 on success or if nothing changed, negative error code from the strip driver
+ */
+int app_led_strip_flush(struct app_led_strip *strip);
 /* @brief Set the color of all LEDs
  *
  * @param leds Pointer to the app_led_data_t structure
@@ -508,8 +1124,68 @@ rgb_color_t app_led_hue_to_rgb(uint8_t hue);
  */
 rgb_color_t app_led_hsv_to_rgb(uint8_t hue, uint8_t sat, uint8_t value);
 
-/* Helper to indicate Rx/Tx activity for example */
+/* @brief Queue a command to be applied at the start of the next update
+ *
+ * Lock-free and safe to call from an ISR, unlike the other API functions which take the mutex.
+ * Requires CONFIG_APP_LED_CMD_QUEUE.
+ *
+ * @param leds Pointer to the app_led_data_t structure
+ * @param cmd Command to copy into the queue
+ * @return 0 on success, -ENOMEM if the queue is full, -ENODEV if not initialized
+ */
+int app_led_cmd_push(app_led_data_t *leds, const struct app_led_cmd *cmd);
+
+/* Helpers to queue each command type with app_led_cmd_push */
+static inline int app_led_post_color(app_led_data_t *leds, rgb_color_t c)
+{
+	struct app_led_cmd cmd = {.type = APP_LED_CMD_SET_COLOR, .set.color = c};
+
+	return app_led_cmd_push(leds, &cmd);
+}
+
+static inline int app_led_post_index(app_led_data_t *leds, uint16_t i, rgb_color_t c)
+{
+	struct app_led_cmd cmd = {.type = APP_LED_CMD_SET_INDEX, .set = {.index = i, .color = c}};
+
+	return app_led_cmd_push(leds, &cmd);
+}
+
+static inline int app_led_post_blink(app_led_data_t *leds, rgb_color_t c, uint32_t on_period_ms,
+				     uint32_t off_period_ms, bool state_override)
+{
+	struct app_led_cmd cmd = {.type = APP_LED_CMD_BLINK,
+				  .blink = {.color = c,
+					    .on_ms = on_period_ms,
+					    .off_ms = off_period_ms,
+					    .state_override = state_override}};
+
+	return app_led_cmd_push(leds, &cmd);
+}
+
+static inline int app_led_post_sequence(app_led_data_t *leds,
+					const app_led_sequence_step_t *sequence, int8_t num_repeat)
+{
+	struct app_led_cmd cmd = {.type = APP_LED_CMD_SEQUENCE,
+				  .sequence = {.steps = sequence, .num_repeat = num_repeat}};
+
+	return app_led_cmd_push(leds, &cmd);
+}
+
+static inline int app_led_post_brightness(app_led_data_t *leds, uint8_t brightness)
+{
+	struct app_led_cmd cmd = {.type = APP_LED_CMD_BRIGHTNESS, .brightness = brightness};
+
+	return app_led_cmd_push(leds, &cmd);
+}
+
+/* Helper to indicate Rx/Tx activity for example; queued when CONFIG_APP_LED_CMD_QUEUE so it can be
+ * used from radio ISRs
+ */
+#if IS_ENABLED(CONFIG_APP_LED_CMD_QUEUE)
+#define app_led_indicate_act(_l, _c) app_led_post_blink(_l, RGBHEX(_c), 20, 30, false);
+#else
 #define app_led_indicate_act(_l, _c) app_led_blink(_l, RGBHEX(_c), 20, 30, false, K_NO_WAIT);
+#endif
 /* Helper to run error sequence */
 #define app_led_error_indicate(_l)                                                                 \
 	app_led_run_sequence(_l, app_led_error_sequence, 0, 4, K_MSEC(5));
@@ -524,14 +1200,14 @@ extern const app_led_sequence_step_t app_led_test_sequence[];
 extern const app_led_sequence_step_t app_led_error_sequence[];
 extern const app_led_sequence_step_t app_led_blank_sequence[];
 extern app_led_sequence_step_t app_led_charging_sequence[];
-extern app_led_sequence_step_t app_led_fade_sequence[];
+extern const app_led_sequence_step_t app_led_fade_sequence[];
 extern const app_led_sequence_step_t app_led_chase_sequence[];
 extern const app_led_sequence_step_t app_led_fade_blink_sequence[];
 extern const app_led_sequence_step_t app_led_half_blink_sequence[];
 extern const app_led_sequence_step_t app_led_sine_sequence[];
 extern const app_led_sequence_step_t app_led_breathe_sequence[];
 extern const app_led_sequence_step_t *app_led_sequences[];
-extern const uint8_t app_led_sequence_lengths[];
+extern const uint16_t app_led_sequence_lengths[];
 void app_led_seq_fnc(void *const leds, const void *const step, k_timeout_t block);
 void app_led_chase(void *const leds, const void *const step, k_timeout_t block);
 void app_led_half_blink(void *const leds, const void *const step, k_timeout_t block);
@@ -4,7 +4,6 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/util.h>
 #include <errno.h>
-#include <math.h>
 #include <stdlib.h>
 #if IS_ENABLED(CONFIG_LED_STRIP)
 #include <zephyr/drivers/led_strip.h>
@@ -20,142 +19,890 @@
 
 LOG_MODULE_REGISTER(app_led, CONFIG_APP_LED_LOG_LEVEL);
 
+#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
+#if IS_ENABLED(CONFIG_APP_LED_SHARED_WORK)
+static void app_led_shared_work_handler(struct k_work *work);
+/* Single work item updating every App LED instance */
+static K_WORK_DELAYABLE_DEFINE(app_led_dwork, app_led_shared_work_handler);
+/* Uptime the shared work is due */
+static int64_t app_led_next_update;
+#define LEDS_DWORK(_leds)	(&app_led_dwork)
+#define LEDS_NEXT_UPDATE(_leds) (app_led_next_update)
+#else
+#define LEDS_DWORK(_leds)	(&(_leds)->dwork)
+#define LEDS_NEXT_UPDATE(_leds) ((_leds)->next_update)
+#endif
+
+#if IS_ENABLED(CONFIG_APP_LED_DEDICATED_WORKQUEUE)
+static K_KERNEL_STACK_DEFINE(app_led_work_q_stack, CONFIG_APP_LED_WORKQUEUE_STACK_SIZE);
+static struct k_work_q app_led_work_q;
+#define LEDS_WORK_Q (&app_led_work_q)
+
+static int app_led_work_q_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "app_led",
+	};
+
+	k_work_queue_init(&app_led_work_q);
+	k_work_queue_start(&app_led_work_q, app_led_work_q_stack,
+			   K_KERNEL_STACK_SIZEOF(app_led_work_q_stack),
+			   CONFIG_APP_LED_WORKQUEUE_PRIORITY, &cfg);
+
+	return 0;
+}
+
+SYS_INIT(app_led_work_q_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+#else
+#define LEDS_WORK_Q (&k_sys_work_q)
+#endif
+
+/* Schedule the next background update of leds in delay_ms */
+static inline void leds_reschedule(app_led_data_t *leds, int64_t now, int32_t delay_ms)
+{
+	LEDS_NEXT_UPDATE(leds) = now + delay_ms;
+	k_work_reschedule_for_queue(LEDS_WORK_Q, LEDS_DWORK(leds), K_MSEC(delay_ms));
+}
+
+/* Schedule an update of leds now
+ *
+ * Work pending for a later deadline, such as the shared work sleeping until another instance's
+ * next blink edge, is pulled in. Work already due or running is left alone so calling this from
+ * the work handler does not loop.
+ */
+static inline void leds_schedule(app_led_data_t *leds)
+{
+	int64_t now = k_uptime_get();
+
+	if (!k_work_delayable_is_pending(LEDS_DWORK(leds)) || LEDS_NEXT_UPDATE(leds) > now) {
+		leds_reschedule(leds, now, 0);
+	}
+}
+
+/* Record how late the update due now ran in leds stats */
+static inline void leds_record_late(app_led_data_t *leds, int64_t now)
+{
+	uint32_t late = (uint32_t)MAX(0, now - LEDS_NEXT_UPDATE(leds));
+
+	leds->stats.last_late_ms = late;
+	if (late > leds->stats.max_late_ms) {
+		leds->stats.max_late_ms = late;
+	}
+
+	if (late > CONFIG_APP_LED_UPDATE_PERIOD) {
+		LOG_DBG("%s update ran %u ms late", leds->app_led->name, late);
+	}
+}
+
+/* Make leds due an update now; a state change is not held off by a long tickless sleep
+ *
+ * ISR safe as app_led_cmd_push calls it: the 64 bit deadlines could tear on a 32 bit target so
+ * only the wake flag is set and the work queued, the handler brings next_change forward.
+ */
+static inline void leds_wake(app_led_data_t *leds)
+{
+	atomic_set(&leds->wake, 1);
+	k_work_reschedule_for_queue(LEDS_WORK_Q, LEDS_DWORK(leds), K_NO_WAIT);
+}
+
+/* Stop background updates of leds; shared work just skips suspended instances */
+static inline void leds_suspend(app_led_data_t *leds)
+{
+	if (!IS_ENABLED(CONFIG_APP_LED_SHARED_WORK)) {
+		k_work_cancel_delayable(LEDS_DWORK(leds));
+	}
+}
+#endif
+
+#if IS_ENABLED(CONFIG_APP_LED_GAMMA)
+/* Generated at build time by scripts/gen_gamma_table.py */
+extern const uint8_t app_led_gamma_table[256];
+#define LEDS_GAMMA(_v) (app_led_gamma_table[(_v)])
+#else
+#define LEDS_GAMMA(_v) (_v)
+#endif
+
+#if IS_ENABLED(CONFIG_APP_LED_BRIGHTNESS_LUT)
+/* Rebuild the cached brightness scale table; call with mutex held */
+static void leds_build_scale_lut(app_led_data_t *leds, uint8_t brightness)
+{
+	for (int i = 0; i < ARRAY_SIZE(leds->scale_lut); i++) {
+		leds->scale_lut[i] = app_led_scale8(i, brightness);
+	}
+	leds->scale_lut_brightness = brightness;
+}
+#endif
+
 #if IS_ENABLED(CONFIG_LED_STRIP)
+/* Back buffer that writers render into; a segment view's starts at its offset in the shared one */
+static inline struct led_rgb *leds_strip_back(const app_led_data_t *leds)
+{
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS)
+	if (leds->strip != NULL) {
+		return (struct led_rgb *)leds->strip->pixels[!atomic_get(&leds->strip->front)] +
+		       leds->offset;
+	}
+#endif
+	return (struct led_rgb *)leds->pixels[!atomic_get(&leds->front)];
+}
+
+/* Commit the back buffer and push it to the strip if any pixel changed since the last flush
+ *
+ * The mutex is only held to swap front/back and bring the new back buffer in line with the new
+ * front; the driver transfer is done from the front buffer without the lock so writers are not
+ * blocked for the length of a frame. Only called from the update work so there is never more than
+ * one flush in progress.
+ *
+ * Only the pixels up to the end of the dirty span are sent; the strip keeps the tail from the
+ * last transfer. CONFIG_APP_LED_STRIP_REFRESH_PERIOD forces a full transfer periodically so a
+ * strip that was disconnected will recover.
+ */
 static void leds_strip_update(app_led_data_t *leds)
 {
-	// TODO leds->offset with strip - maybe need to override strip->update_rgb
-	if (k_mutex_lock(&leds->mutex, K_FOREVER) == 0) {
-		if (led_strip_update_rgb(leds->app_led, leds->pixels, leds->hw_num_leds) != 0) {
-			LOG_ERR("Couldn't update strip");
-		}
+	struct led_rgb *front;
+	int64_t now = k_uptime_get();
+	uint16_t len;
+	atomic_val_t f;
+
+	if (k_mutex_lock(&leds->mutex, K_FOREVER) != 0) {
+		return;
+	}
+
+	if (CONFIG_APP_LED_STRIP_REFRESH_PERIOD > 0 &&
+	    now - leds->last_flush >= CONFIG_APP_LED_STRIP_REFRESH_PERIOD) {
+		leds->dirty_start = 0;
+		leds->dirty_end = leds->hw_num_leds;
+	}
 
+	if (leds->dirty_end == 0) {
+		leds->stats.skipped_flushes++;
 		k_mutex_unlock(&leds->mutex);
+		return;
+	}
+
+	// swap so the rendered frame becomes front
+	f = !atomic_get(&leds->front);
+	atomic_set(&leds->front, f);
+	front = (struct led_rgb *)leds->pixels[f];
+	// the driver is allowed to overwrite the buffer it sends so copy all of it, not just the
+	// dirty span
+	memcpy(leds->pixels[!f], front, leds->hw_num_leds * sizeof(struct led_rgb));
+	len = leds->dirty_end;
+	leds->dirty_start = 0;
+	leds->dirty_end = 0;
+	leds->last_flush = now;
+
+	k_mutex_unlock(&leds->mutex);
+
+	if (led_strip_update_rgb(leds->app_led, front, len) != 0) {
+		LOG_ERR("Couldn't update strip");
+		// back buffer still has the frame so mark it dirty to retry next update
+		if (k_mutex_lock(&leds->mutex, K_FOREVER) == 0) {
+			leds->dirty_start = 0;
+			leds->dirty_end = MAX(leds->dirty_end, len);
+			k_mutex_unlock(&leds->mutex);
+		}
+	} else {
+		leds->stats.flushes++;
 	}
 }
 
-/* Set the device level LED data and update app_led
+/* Render pixels into the back buffer; call with mutex held
  *
- * Zephyr LED strip uses a different RGB struct to the app_led struct so convert
- * to that. Work is submitted to update the LED strip because the LED strip
- * driver is not ISR safe.
- * */
-static int led_set_strip_pixels(app_led_data_t *leds, uint16_t start, uint16_t end, rgb_color_t c,
-				uint8_t brightness, k_timeout_t block)
+ * Zephyr LED strip uses a different RGB struct to the app_led struct so convert to that. Only
+ * pixels that actually change extend the dirty span so an unchanged frame is not flushed again.
+ */
+static int leds_strip_write_span(app_led_data_t *leds, uint16_t start, uint16_t end,
+				 const rgb_color_t *c, size_t stride, uint8_t brightness)
 {
+	struct led_rgb *pixels = leds_strip_back(leds);
 	struct led_rgb c_rgb;
+	rgb_color_t scaled;
 
-	if (start < leds->hw_num_leds && end <= leds->hw_num_leds) {
-		// scale
-		c.r = (uint8_t)((uint16_t)c.r * brightness / 255);
-		c.g = (uint8_t)((uint16_t)c.g * brightness / 255);
-		c.b = (uint8_t)((uint16_t)c.b * brightness / 255);
-
+	scaled = app_led_scale_color(leds, *c, brightness);
+	for (int i = start; i < end; i++, c = app_led_span_next(c, stride)) {
+		// only scale again if walking an array
+		if (stride != 0 && i != start) {
+			scaled = app_led_scale_color(leds, *c, brightness);
+		}
+		// _color keeps the linear value so effects reading it back are not corrected twice
 		c_rgb = (struct led_rgb){
-			.r = c.r,
-			.g = c.g,
-			.b = c.b,
+			.r = LEDS_GAMMA(scaled.r),
+			.g = LEDS_GAMMA(scaled.g),
+			.b = LEDS_GAMMA(scaled.b),
 		};
 
-		struct led_rgb *pixels = (struct led_rgb *)leds->pixels;
-		for (int i = start; i < end; i++) {
+		if (memcmp(&pixels[i], &c_rgb, sizeof(struct led_rgb)) != 0) {
 			memcpy(&pixels[i], &c_rgb, sizeof(struct led_rgb));
-			leds->state[i]._color = c;
+			app_led_mark_dirty(leds, i);
 		}
+		IF_DISABLED(CONFIG_APP_LED_SINGLE_STORE, (leds->state[i]._color = scaled;))
+	}
+	leds->_color = scaled;
 
+	return 0;
+}
+
+/* The strip driver is not ISR safe and a transfer is long so the rendered frame is flushed from
+ * the update work by leds_strip_update rather than here
+ */
+static int leds_strip_commit(app_led_data_t *leds)
+{
 #if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
-		/* Schedule the work to update the LED strip if not already pending
-		 * function is can be call from workqueue context but pending still true until return so
-		 * this doesn't end up a loop
-		 *
-		 * Required if manual mode or off to schedule outside of potential ISR context
-		 */
-		if (!k_work_is_pending((struct k_work *)&leds->dwork)) {
-			k_work_schedule(&leds->dwork, K_NO_WAIT);
-		}
+	/* Schedule the work to flush the LED strip now, even if it is pending for a later deadline
+	 * so a write in Manual mode is not held off by a long tickless sleep
+	 *
+	 * Required if manual mode or off to schedule outside of potential ISR context.
+	 */
+	leds_schedule(leds);
 #endif
+
+	return 0;
+}
+
+const struct app_led_funcs app_led_strip_funcs = {
+	.write_span = leds_strip_write_span,
+	.commit = leds_strip_commit,
+	.flush = leds_strip_update,
+};
+
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE)
+BUILD_ASSERT(CONFIG_APP_LED_STRIP_PALETTE_BITS == 4 || CONFIG_APP_LED_STRIP_PALETTE_BITS == 8,
+	     "CONFIG_APP_LED_STRIP_PALETTE_BITS must be 4 or 8");
+
+/* Palette index of pixel i */
+static inline uint8_t leds_palette_get(const app_led_data_t *leds, uint16_t i)
+{
+	if (CONFIG_APP_LED_STRIP_PALETTE_BITS == 4) {
+		return (leds->palette_frame[i / 2] >> ((i & 1) * 4)) & 0xF;
+	}
+
+	return leds->palette_frame[i];
+}
+
+/* Set the palette index of pixel i */
+static inline void leds_palette_put(app_led_data_t *leds, uint16_t i, uint8_t index)
+{
+	uint8_t *b = &leds->palette_frame[CONFIG_APP_LED_STRIP_PALETTE_BITS == 4 ? i / 2 : i];
+
+	if (CONFIG_APP_LED_STRIP_PALETTE_BITS == 4) {
+		*b = (*b & ~(0xF << ((i & 1) * 4))) | (index << ((i & 1) * 4));
 	} else {
-		LOG_ERR("LED index out of range");
-		return -EINVAL;
+		*b = index;
+	}
+}
+
+/* Drop palette entries added by writers that no pixel uses any more, so a full palette can take
+ * new colours; O(pixels) so only run once a frame when the palette is full. Entries set with
+ * app_led_palette_set are kept in place.
+ */
+static void leds_palette_reclaim(app_led_data_t *leds)
+{
+	uint32_t used[DIV_ROUND_UP(APP_LED_PALETTE_SIZE, 32)] = {0};
+	uint8_t remap[APP_LED_PALETTE_SIZE];
+	uint16_t len = leds->palette_fixed;
+	uint8_t index;
+
+	for (uint16_t i = 0; i < leds->hw_num_leds; i++) {
+		index = leds_palette_get(leds, i);
+		used[index / 32] |= BIT(index % 32);
 	}
 
-	leds->_color = c;
+	for (uint16_t p = 0; p < leds->palette_len; p++) {
+		if (p < leds->palette_fixed) {
+			remap[p] = p;
+		} else if (used[p / 32] & BIT(p % 32)) {
+			leds->palette[len] = leds->palette[p];
+			remap[p] = len++;
+		}
+	}
+
+	if (len == leds->palette_len) {
+		return;
+	}
+
+	// same colours at new indices so the output does not change
+	for (uint16_t i = 0; i < leds->hw_num_leds; i++) {
+		leds_palette_put(leds, i, remap[leds_palette_get(leds, i)]);
+	}
+	leds->palette_len = len;
+}
+
+/* Palette index of c, adding it if there is room or else the nearest entry */
+static uint8_t leds_palette_lookup(app_led_data_t *leds, rgb_color_t c)
+{
+	uint16_t best = 0;
+	uint16_t best_dist = UINT16_MAX;
+	uint16_t dist;
+	const rgb_color_t *e;
+
+	for (uint16_t p = 0; p < leds->palette_len; p++) {
+		e = &leds->palette[p];
+		if (e->r == c.r && e->g == c.g && e->b == c.b) {
+			return p;
+		}
+		dist = abs(e->r - c.r) + abs(e->g - c.g) + abs(e->b - c.b);
+		if (dist < best_dist) {
+			best_dist = dist;
+			best = p;
+		}
+	}
+
+	// further misses this frame take the nearest entry rather than scanning the strip again
+	if (leds->palette_len == APP_LED_PALETTE_SIZE && !leds->palette_reclaimed) {
+		leds->palette_reclaimed = true;
+		leds_palette_reclaim(leds);
+	}
+
+	if (leds->palette_len < APP_LED_PALETTE_SIZE) {
+		leds->palette[leds->palette_len] = c;
+		return leds->palette_len++;
+	}
+
+	return best;
+}
+
+/* Allow one reclaim of a full palette in the frame */
+static void leds_palette_begin_frame(app_led_data_t *leds)
+{
+	leds->palette_reclaimed = false;
+}
+
+/* Show the palette at brightness from the next flush, expanding every pixel again if it changed */
+static inline void leds_palette_brightness(app_led_data_t *leds, uint8_t brightness)
+{
+	if (brightness != leds->palette_brightness) {
+		leds->palette_brightness = brightness;
+		leds->dirty_start = 0;
+		leds->dirty_end = leds->hw_num_leds;
+	}
+}
+
+/* Render pixels as palette indices; call with mutex held
+ *
+ * Colours are looked up before brightness, which the whole palette is scaled by at flush, so the
+ * steps of a brightness fade reuse the entries rather than each adding its own.
+ */
+static int leds_palette_write_span(app_led_data_t *leds, uint16_t start, uint16_t end,
+				   const rgb_color_t *c, size_t stride, uint8_t brightness)
+{
+	const rgb_color_t *last = c;
+	uint8_t index;
+
+	leds_palette_brightness(leds, brightness);
+	index = leds_palette_lookup(leds, *c);
+	for (int i = start; i < end; i++, c = app_led_span_next(c, stride)) {
+		// only look up again if walking an array
+		if (stride != 0 && i != start) {
+			last = c;
+			index = leds_palette_lookup(leds, *c);
+		}
+
+		if (leds_palette_get(leds, i) != index) {
+			leds_palette_put(leds, i, index);
+			app_led_mark_dirty(leds, i);
+		}
+	}
+	leds->_color = app_led_scale_color(leds, *last, brightness);
 
 	return 0;
 }
-#endif
 
-#if IS_ENABLED(CONFIG_LED_PWM)
-static int leds_set_pwm_brightness(app_led_data_t *leds, uint8_t i, uint8_t value,
-				   k_timeout_t block)
+/* Expand the palette indices into the strip buffer in one pass and push it to the strip
+ *
+ * There is only the one led_rgb buffer, which the driver may overwrite, so the indices up to the
+ * end of the dirty span are expanded into it before every transfer. The mutex is held for the
+ * expansion but not the transfer.
+ */
+static void leds_palette_update(app_led_data_t *leds)
 {
-	const struct app_led_pwm_config *config = leds->app_led->config;
-	const struct pwm_dt_spec *dt_led;
-	int err;
-	i += leds->offset;
+	struct led_rgb *pixels = leds->pixels[0];
+	int64_t now = k_uptime_get();
+	struct led_rgb px = {0};
+	rgb_color_t scaled;
+	uint16_t index = UINT16_MAX;
+	uint16_t len;
 
-	if (i >= config->num_leds || value > 255) {
-		return -EINVAL;
+	if (k_mutex_lock(&leds->mutex, K_FOREVER) != 0) {
+		return;
 	}
 
-	dt_led = &config->led[i];
+	if (CONFIG_APP_LED_STRIP_REFRESH_PERIOD > 0 &&
+	    now - leds->last_flush >= CONFIG_APP_LED_STRIP_REFRESH_PERIOD) {
+		leds->dirty_end = leds->hw_num_leds;
+	}
 
-	if (k_mutex_lock(&leds->mutex, block) == 0) {
-		err = pwm_set_pulse_dt(&config->led[i], dt_led->period * value / 255);
+	if (leds->dirty_end == 0) {
+		leds->stats.skipped_flushes++;
 		k_mutex_unlock(&leds->mutex);
-		return err;
+		return;
+	}
+
+	len = leds->dirty_end;
+	for (uint16_t i = 0; i < len; i++) {
+		// runs of one index are scaled once
+		if (leds_palette_get(leds, i) != index) {
+			index = leds_palette_get(leds, i);
+			scaled = app_led_scale_color(leds, leds->palette[index],
+						     leds->palette_brightness);
+			px = (struct led_rgb){
+				.r = LEDS_GAMMA(scaled.r),
+				.g = LEDS_GAMMA(scaled.g),
+				.b = LEDS_GAMMA(scaled.b),
+			};
+		}
+		pixels[i] = px;
+	}
+	leds->dirty_start = 0;
+	leds->dirty_end = 0;
+	leds->last_flush = now;
+
+	k_mutex_unlock(&leds->mutex);
+
+	if (led_strip_update_rgb(leds->app_led, pixels, len) != 0) {
+		LOG_ERR("Couldn't update strip");
+		// indices are unchanged so expand them again next update
+		if (k_mutex_lock(&leds->mutex, K_FOREVER) == 0) {
+			leds->dirty_start = 0;
+			leds->dirty_end = MAX(leds->dirty_end, len);
+			k_mutex_unlock(&leds->mutex);
+		}
 	} else {
-		return -EBUSY;
+		leds->stats.flushes++;
 	}
 }
+
+const struct app_led_funcs app_led_strip_palette_funcs = {
+	.begin_frame = leds_palette_begin_frame,
+	.write_span = leds_palette_write_span,
+	.commit = leds_strip_commit,
+	.flush = leds_palette_update,
+};
 #endif
 
-#if IS_ENABLED(CONFIG_LED_GPIO)
-static int leds_set_gpio_brightness(app_led_data_t *leds, uint8_t i, uint8_t value,
-				    k_timeout_t block)
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS)
+/* Extend the dirty span of a shared strip to include [start, end); call with strip mutex held */
+static inline void leds_shared_mark_dirty(struct app_led_strip *strip, uint16_t start,
+					  uint16_t end)
 {
-	const struct led_gpio_config *config = leds->app_led->config;
-	const struct gpio_dt_spec *led_gpio;
+	if (strip->dirty_end == 0 || start < strip->dirty_start) {
+		strip->dirty_start = start;
+	}
+	strip->dirty_end = MAX(strip->dirty_end, end);
+}
+
+/* Flush the shared strip as leds_strip_update does for a strip instance, so views are never held
+ * off for the transfer; only one flush is in progress as it runs from the one flush work
+ */
+int app_led_strip_flush(struct app_led_strip *strip)
+{
+	struct led_rgb *front;
+	int64_t now = k_uptime_get();
+	uint16_t len;
+	atomic_val_t f;
 	int err;
-	i += leds->offset;
 
-	if ((i >= config->num_leds) || (value > 255)) {
-		return -EINVAL;
+	if (k_mutex_lock(&strip->mutex, K_FOREVER) != 0) {
+		return -EBUSY;
 	}
 
-	if (k_mutex_lock(&leds->mutex, block) == 0) {
-		led_gpio = &config->led[i];
+	if (CONFIG_APP_LED_STRIP_REFRESH_PERIOD > 0 &&
+	    now - strip->last_flush >= CONFIG_APP_LED_STRIP_REFRESH_PERIOD) {
+		leds_shared_mark_dirty(strip, 0, strip->num_leds);
+	}
 
-		// on if value > 127
-		err = gpio_pin_set_dt(led_gpio, value > 127);
-		k_mutex_unlock(&leds->mutex);
-		return err;
+	if (strip->dirty_end == 0) {
+		strip->skipped_flushes++;
+		k_mutex_unlock(&strip->mutex);
+		return 0;
+	}
+
+	f = !atomic_get(&strip->front);
+	atomic_set(&strip->front, f);
+	front = (struct led_rgb *)strip->pixels[f];
+	memcpy(strip->pixels[!f], front, strip->num_leds * sizeof(struct led_rgb));
+	len = strip->dirty_end;
+	strip->dirty_start = 0;
+	strip->dirty_end = 0;
+	strip->last_flush = now;
+
+	k_mutex_unlock(&strip->mutex);
+
+	err = led_strip_update_rgb(strip->dev, front, len);
+	if (err != 0) {
+		LOG_ERR("Couldn't update strip");
+		if (k_mutex_lock(&strip->mutex, K_FOREVER) == 0) {
+			leds_shared_mark_dirty(strip, 0, len);
+			k_mutex_unlock(&strip->mutex);
+		}
 	} else {
-		return -EBUSY;
+		strip->flushes++;
 	}
+
+	return err;
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
+static void leds_shared_flush_handler(struct k_work *work)
+{
+	app_led_strip_flush(CONTAINER_OF(work, struct app_led_strip, flush_work));
 }
 #endif
 
-static int leds_set_brightness(app_led_data_t *leds, uint8_t i, uint8_t value, k_timeout_t block)
+/* Set up the shared strip with its first view; views are checked against it at build time */
+static int leds_segment_init(app_led_data_t *leds)
 {
-	switch (leds->hw_type) {
+	struct app_led_strip *strip = leds->strip;
+
+	if (leds->offset + leds->hw_num_leds > strip->num_leds) {
+		return -EINVAL;
+	}
+
+	if (k_mutex_lock(&strip->mutex, K_FOREVER) != 0) {
+		return -EBUSY;
+	}
+
+	if (!strip->initialized) {
+		IF_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE,
+			   (k_work_init(&strip->flush_work, leds_shared_flush_handler);))
+		strip->initialized = true;
+	}
+
+	k_mutex_unlock(&strip->mutex);
+
+	return 0;
+}
+
+/* Render into the view's part of the shared back buffer as a strip would and carry the view's
+ * dirty span over to the strip; call with mutex held
+ */
+static int leds_segment_write_span(app_led_data_t *leds, uint16_t start, uint16_t end,
+				   const rgb_color_t *c, size_t stride, uint8_t brightness)
+{
+	struct app_led_strip *strip = leds->strip;
+	int err;
+
+	if (k_mutex_lock(&strip->mutex, K_FOREVER) != 0) {
+		return -EBUSY;
+	}
+
+	err = leds_strip_write_span(leds, start, end, c, stride, brightness);
+	if (leds->dirty_end != 0) {
+		leds_shared_mark_dirty(strip, leds->offset + leds->dirty_start,
+				       leds->offset + leds->dirty_end);
+	}
+
+	k_mutex_unlock(&strip->mutex);
+
+	return err;
+}
+
+/* The pixels are already marked in the shared strip so the view's span is done with */
+static int leds_segment_commit(app_led_data_t *leds)
+{
+	leds->dirty_start = 0;
+	leds->dirty_end = 0;
+
+	return leds_strip_commit(leds);
+}
+
+/* Queue the shared flush after the view's update; it is only queued once however many views
+ * update before the work queue gets to it
+ */
+static void leds_segment_flush(app_led_data_t *leds)
+{
+#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
+	struct app_led_strip *strip = leds->strip;
+	bool dirty;
+
+	// other views write the shared span under the strip mutex
+	if (k_mutex_lock(&strip->mutex, K_FOREVER) != 0) {
+		return;
+	}
+	dirty = strip->dirty_end != 0;
+	k_mutex_unlock(&strip->mutex);
+
+	if (dirty || CONFIG_APP_LED_STRIP_REFRESH_PERIOD > 0) {
+		k_work_submit_to_queue(LEDS_WORK_Q, &strip->flush_work);
+	}
+#endif
+}
+
+const struct app_led_funcs app_led_strip_segment_funcs = {
+	.init = leds_segment_init,
+	.write_span = leds_segment_write_span,
+	.commit = leds_segment_commit,
+	.flush = leds_segment_flush,
+};
+#endif
+#endif
+
+/* hw_shadow value for a channel whose hardware state is unknown, so the next commit writes it */
+#define LEDS_HW_UNKNOWN UINT32_MAX
+
 #if IS_ENABLED(CONFIG_LED_PWM)
-	case APP_LED_TYPE_PWM:
-		return leds_set_pwm_brightness(leds, i, value, block);
+/* Pulse width for a PWM channel value */
+static uint32_t leds_pwm_level(app_led_data_t *leds, uint16_t i, uint8_t value)
+{
+	const struct app_led_pwm_config *config = leds->app_led->config;
+	const struct pwm_dt_spec *dt_led = &config->led[i + leds->offset];
+
+	return dt_led->period * LEDS_GAMMA(value) / 255;
+}
+
+/* Write each PWM channel in the dirty span whose pulse differs from the last one written */
+static int leds_commit_pwm_channels(app_led_data_t *leds)
+{
+	const struct app_led_pwm_config *config = leds->app_led->config;
+	const uint8_t *frame = leds->channels;
+	uint32_t level;
+	int err;
+
+	for (uint16_t i = leds->dirty_start; i < leds->dirty_end; i++) {
+		level = leds_pwm_level(leds, i, frame[i]);
+		if (level == leds->hw_shadow[i]) {
+			leds->stats.hw_writes_elided++;
+			continue;
+		}
+
+		err = pwm_set_pulse_dt(&config->led[i + leds->offset], level);
+		if (err != 0) {
+			// state unknown after a failed write; leave the rest of the span dirty to retry
+			leds->hw_shadow[i] = LEDS_HW_UNKNOWN;
+			leds->dirty_start = i;
+			return err;
+		}
+		leds->hw_shadow[i] = level;
+		leds->stats.hw_writes++;
+	}
+
+	return 0;
+}
 #endif
+
 #if IS_ENABLED(CONFIG_LED_GPIO)
-	case APP_LED_TYPE_GPIO:
-		return leds_set_gpio_brightness(leds, i, value, block);
-#endif
-	default:
-		LOG_ERR("Unsupported LED type: should not be here!");
-		return -EINVAL;
+/* Group the pins of leds by GPIO port so a commit is one write per port */
+static void leds_gpio_group_ports(app_led_data_t *leds)
+{
+	const struct led_gpio_config *config = leds->app_led->config;
+	const struct gpio_dt_spec *spec;
+	uint8_t p;
+
+	leds->num_gpio_ports = 0;
+	for (int i = 0; i < leds->hw_num_leds && i + leds->offset < config->num_leds; i++) {
+		spec = &config->led[i + leds->offset];
+		for (p = 0; p < leds->num_gpio_ports; p++) {
+			if (leds->gpio_ports[p].port == spec->port) {
+				break;
+			}
+		}
+
+		if (p == leds->num_gpio_ports) {
+			leds->gpio_ports[p] = (struct app_led_gpio_port){.port = spec->port};
+			leds->num_gpio_ports++;
+		}
+		IF_ENABLED(CONFIG_APP_LED_GPIO_BCM, (leds->gpio_ports[p].pins |= BIT(spec->pin);))
 	}
+
+	LOG_DBG("%s %u pins on %u ports", leds->app_led->name, leds->hw_num_leds,
+		leds->num_gpio_ports);
 }
 
-static int leds_set_pin_pixel(app_led_data_t *leds, uint16_t i, rgb_color_t c, uint8_t brightness,
-			      k_timeout_t block)
+static struct app_led_gpio_port *leds_gpio_port(app_led_data_t *leds, const struct device *port)
 {
-	int err;
+	for (uint8_t p = 0; p < leds->num_gpio_ports; p++) {
+		if (leds->gpio_ports[p].port == port) {
+			return &leds->gpio_ports[p];
+		}
+	}
+
+	return NULL;
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_GPIO_BCM)
+#define LEDS_BCM_LEVELS (BIT(CONFIG_APP_LED_GPIO_BCM_BITS) - 1U)
+/* Display time of bit plane 0; plane b is shown for BIT(b) slots so a refresh is LEDS_BCM_LEVELS
+ * slots
+ */
+#define LEDS_BCM_SLOT_US (USEC_PER_SEC / (CONFIG_APP_LED_GPIO_BCM_REFRESH_HZ * LEDS_BCM_LEVELS))
+
+BUILD_ASSERT(LEDS_BCM_SLOT_US > 0, "CONFIG_APP_LED_GPIO_BCM_REFRESH_HZ too high for bit depth");
+
+/* Show the next bit plane on every port and time it for its weight
+ *
+ * Runs in ISR context from the timer. Planes are only read under bcm_lock so a commit is never
+ * half applied.
+ */
+static void leds_bcm_timer_handler(struct k_timer *timer)
+{
+	app_led_data_t *leds = k_timer_user_data_get(timer);
+	uint32_t start = k_cycle_get_32();
+	k_spinlock_key_t key;
+	uint32_t cycles;
+	uint8_t b;
+
+	key = k_spin_lock(&leds->bcm_lock);
+	b = leds->bcm_plane;
+	for (uint8_t p = 0; p < leds->num_gpio_ports; p++) {
+		(void)gpio_port_set_masked(leds->gpio_ports[p].port, leds->gpio_ports[p].pins,
+					   leds->gpio_ports[p].planes[b]);
+	}
+	leds->bcm_plane = (b + 1) % CONFIG_APP_LED_GPIO_BCM_BITS;
+	k_spin_unlock(&leds->bcm_lock, key);
+
+	k_timer_start(timer, K_USEC(LEDS_BCM_SLOT_US << b), K_NO_WAIT);
+
+	cycles = k_cycle_get_32() - start;
+	leds->stats.bcm_isr_count++;
+	leds->stats.bcm_isr_cycles += cycles;
+	leds->stats.bcm_isr_max_cycles = MAX(leds->stats.bcm_isr_max_cycles, cycles);
+}
+
+/* Update the bit planes of the GPIO channels in the dirty span with LEDS_BCM_LEVELS of
+ * brightness
+ *
+ * The timer only runs while a pin is between off and full on; otherwise the ports are written
+ * once and left static.
+ */
+static int leds_commit_gpio_bcm(app_led_data_t *leds)
+{
+	const struct led_gpio_config *config = leds->app_led->config;
+	const uint8_t *frame = leds->channels;
+	const struct gpio_dt_spec *spec;
+	struct app_led_gpio_port *port;
+	k_spinlock_key_t key;
+	bool modulated = false;
+	uint32_t level;
+	int err = 0;
+	int ret;
+
+	key = k_spin_lock(&leds->bcm_lock);
+	for (uint16_t i = leds->dirty_start; i < leds->dirty_end; i++) {
+		level = LEDS_GAMMA(frame[i]) >> (8 - CONFIG_APP_LED_GPIO_BCM_BITS);
+		if (level == leds->hw_shadow[i]) {
+			leds->stats.hw_writes_elided++;
+			continue;
+		}
+
+		spec = &config->led[i + leds->offset];
+		port = leds_gpio_port(leds, spec->port);
+		if (port == NULL) {
+			k_spin_unlock(&leds->bcm_lock, key);
+			return -EINVAL;
+		}
+		for (uint8_t b = 0; b < CONFIG_APP_LED_GPIO_BCM_BITS; b++) {
+			WRITE_BIT(port->planes[b], spec->pin, (level & BIT(b)) != 0);
+		}
+		leds->hw_shadow[i] = level;
+	}
+
+	for (uint8_t p = 0; p < leds->num_gpio_ports && !modulated; p++) {
+		for (uint8_t b = 1; b < CONFIG_APP_LED_GPIO_BCM_BITS; b++) {
+			modulated |= leds->gpio_ports[p].planes[b] != leds->gpio_ports[p].planes[0];
+		}
+	}
+	k_spin_unlock(&leds->bcm_lock, key);
+
+	// timer is not set up until init; show the nearest on/off level until then
+	if (modulated && leds->initialized) {
+		if (!leds->bcm_running) {
+			leds->bcm_running = true;
+			k_timer_start(&leds->bcm_timer, K_NO_WAIT, K_NO_WAIT);
+		}
+		return 0;
+	}
+
+	if (leds->bcm_running) {
+		leds->bcm_running = false;
+		k_timer_stop(&leds->bcm_timer);
+	}
+
+	for (uint8_t p = 0; p < leds->num_gpio_ports; p++) {
+		port = &leds->gpio_ports[p];
+		ret = gpio_port_set_masked(port->port, port->pins,
+					   port->planes[CONFIG_APP_LED_GPIO_BCM_BITS - 1]);
+		if (ret != 0) {
+			err = ret;
+			continue;
+		}
+		leds->stats.hw_writes++;
+	}
+
+	if (err != 0) {
+		for (uint16_t i = leds->dirty_start; i < leds->dirty_end; i++) {
+			leds->hw_shadow[i] = LEDS_HW_UNKNOWN;
+		}
+	}
+
+	return err;
+}
+#else
+/* Write the GPIO channels in the dirty span whose pin state changed, with one masked write per
+ * port so pins on the same port (an RGB LED for example) change together
+ */
+static int leds_commit_gpio_ports(app_led_data_t *leds)
+{
+	const struct led_gpio_config *config = leds->app_led->config;
+	const uint8_t *frame = leds->channels;
+	const struct gpio_dt_spec *spec;
+	struct app_led_gpio_port *port;
+	uint32_t level;
+	int err = 0;
+	int ret;
+
+	for (uint8_t p = 0; p < leds->num_gpio_ports; p++) {
+		leds->gpio_ports[p].mask = 0;
+		leds->gpio_ports[p].value = 0;
+	}
+
+	for (uint16_t i = leds->dirty_start; i < leds->dirty_end; i++) {
+		level = frame[i] > 127;
+		if (level == leds->hw_shadow[i]) {
+			leds->stats.hw_writes_elided++;
+			continue;
+		}
+
+		spec = &config->led[i + leds->offset];
+		port = leds_gpio_port(leds, spec->port);
+		if (port == NULL) {
+			return -EINVAL;
+		}
+		port->mask |= BIT(spec->pin);
+		if (level != 0) {
+			port->value |= BIT(spec->pin);
+		}
+	}
+
+	for (uint8_t p = 0; p < leds->num_gpio_ports; p++) {
+		port = &leds->gpio_ports[p];
+		if (port->mask == 0) {
+			continue;
+		}
+
+		ret = gpio_port_set_masked(port->port, port->mask, port->value);
+		if (ret != 0) {
+			err = ret;
+			continue;
+		}
+		leds->stats.hw_writes++;
+	}
+
+	for (uint16_t i = leds->dirty_start; i < leds->dirty_end; i++) {
+		// a failed port write leaves every pin unknown to retry on the next commit
+		leds->hw_shadow[i] = err != 0 ? LEDS_HW_UNKNOWN : (uint32_t)(frame[i] > 127);
+	}
+
+	return err;
+}
+#endif
+#endif
+
+/* Render logical pixel i into the channel frame; call with mutex held */
+static int leds_render_pin_pixel(app_led_data_t *leds, uint16_t i, rgb_color_t c)
+{
+	uint8_t *frame = leds->channels;
+	uint16_t ch;
+	uint8_t value;
 	/* TODO use cell_size from app_led_data_t but not properly defined yet */
 	// uint8_t cell_size = leds->cell_size;
 	uint8_t cell_size = leds->is_rgb ? 3 : 1;
@@ -165,98 +912,377 @@ static int leds_set_pin_pixel(app_led_data_t *leds, uint16_t i, rgb_color_t c, u
 		return -EINVAL;
 	}
 
-	if (leds->is_rgb) {
-		for (int j = 0; j < cell_size; j++) {
-			err = leds_set_brightness(leds, i * cell_size + j, c.bytes[j % 3], block);
-			if (err != 0) {
-				return err;
-			}
-		}
-	} else {
 #if IS_ENABLED(CONFIG_APP_LED_GRAYSCALE_WEIGHTED)
-		uint8_t grayscale_brightness =
-			(uint8_t)(0.299 * c.r + 0.587 * c.g + 0.114 * c.b);
+	uint8_t grayscale_brightness = app_led_grayscale(c);
 #elif IS_ENABLED(CONFIG_APP_LED_GRAYSCALE_AVERAGE)
-		uint8_t grayscale_brightness = (uint8_t)(((uint16_t)c.r + c.g + c.b) / 3);
+	uint8_t grayscale_brightness = (uint8_t)(((uint16_t)c.r + c.g + c.b) / 3);
 #else
-		uint8_t grayscale_brightness = c.hex > 0 ? 255 : 0;
+	uint8_t grayscale_brightness = c.hex > 0 ? 255 : 0;
 #endif
-		for (int j = 0; j < cell_size; j++) {
-			err = leds_set_brightness(leds, i * cell_size + j, grayscale_brightness, block);
-			if (err != 0) {
-				return err;
-			}
+
+	for (int j = 0; j < cell_size; j++) {
+		ch = i * cell_size + j;
+		value = leds->is_rgb ? c.bytes[j % 3] : grayscale_brightness;
+		if (frame[ch] != value) {
+			frame[ch] = value;
+			app_led_mark_dirty(leds, ch);
+		}
+	}
+
+	IF_DISABLED(CONFIG_APP_LED_SINGLE_STORE, (leds->state[i]._color = c;))
+
+	return 0;
+}
+
+/* Render pixels into the channel frame; call with mutex held */
+static int leds_pin_write_span(app_led_data_t *leds, uint16_t start, uint16_t end,
+			       const rgb_color_t *c, size_t stride, uint8_t brightness)
+{
+	rgb_color_t scaled;
+	int err = 0;
+
+	scaled = app_led_scale_color(leds, *c, brightness);
+	for (int i = start; i < end; i++, c = app_led_span_next(c, stride)) {
+		// only scale again if walking an array
+		if (stride != 0 && i != start) {
+			scaled = app_led_scale_color(leds, *c, brightness);
+		}
+
+		err = leds_render_pin_pixel(leds, i, scaled);
+		if (err != 0) {
+			break;
+		}
+	}
+
+	// TODO this is legacy and not representative of the actual color if changing sector
+	// it's just used for toggle whole strip
+	leds->_color = scaled;
+
+	return err;
+}
+
+/* Finish a pin commit: the span is clean once every channel in it was written */
+static inline int leds_pin_commit_done(app_led_data_t *leds, int err)
+{
+	if (err == 0) {
+		leds->dirty_start = 0;
+		leds->dirty_end = 0;
+	}
+
+	return err;
+}
+
+#if IS_ENABLED(CONFIG_LED_PWM)
+/* Write the channels in the dirty span whose pulse differs from the last one written; values
+ * the gamma table rounds to the same pulse are elided against hw_shadow
+ */
+static int leds_pwm_commit(app_led_data_t *leds)
+{
+	const struct app_led_pwm_config *config = leds->app_led->config;
+
+	if (leds->dirty_end + leds->offset > config->num_leds) {
+		LOG_ERR("LED index out of range");
+		return -EINVAL;
+	}
+
+	return leds_pin_commit_done(leds, leds_commit_pwm_channels(leds));
+}
+
+const struct app_led_funcs app_led_pwm_funcs = {
+	.write_span = leds_pin_write_span,
+	.commit = leds_pwm_commit,
+};
+#endif
+
+#if IS_ENABLED(CONFIG_LED_GPIO)
+static int leds_gpio_init(app_led_data_t *leds)
+{
+	leds_gpio_group_ports(leds);
+#if IS_ENABLED(CONFIG_APP_LED_GPIO_BCM)
+	k_timer_init(&leds->bcm_timer, leds_bcm_timer_handler, NULL);
+	k_timer_user_data_set(&leds->bcm_timer, leds);
+#endif
+
+	return 0;
+}
+
+static void leds_gpio_begin_frame(app_led_data_t *leds)
+{
+	// ports are grouped on first use so a frame before app_led_init still works
+	if (leds->num_gpio_ports == 0) {
+		leds_gpio_group_ports(leds);
+	}
+}
+
+/* Write the channels in the dirty span whose pin state changed, one write per port */
+static int leds_gpio_commit(app_led_data_t *leds)
+{
+	const struct led_gpio_config *config = leds->app_led->config;
+
+	if (leds->dirty_end + leds->offset > config->num_leds) {
+		LOG_ERR("LED index out of range");
+		return -EINVAL;
+	}
+
+#if IS_ENABLED(CONFIG_APP_LED_GPIO_BCM)
+	return leds_pin_commit_done(leds, leds_commit_gpio_bcm(leds));
+#else
+	return leds_pin_commit_done(leds, leds_commit_gpio_ports(leds));
+#endif
+}
+
+const struct app_led_funcs app_led_gpio_funcs = {
+	.init = leds_gpio_init,
+	.begin_frame = leds_gpio_begin_frame,
+	.write_span = leds_pin_write_span,
+	.commit = leds_gpio_commit,
+};
+#endif
+
+/* With only one LED driver class enabled every instance uses that backend, so call it directly and
+ * let the compiler inline the whole update; otherwise dispatch through the instance's funcs
+ */
+#define LEDS_NUM_BACKENDS                                                                          \
+	(IS_ENABLED(CONFIG_LED_STRIP) + IS_ENABLED(CONFIG_LED_PWM) + IS_ENABLED(CONFIG_LED_GPIO))
+#if LEDS_NUM_BACKENDS == 1 && !IS_ENABLED(CONFIG_APP_LED_CUSTOM_BACKEND) &&                        \
+	!IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE) && !IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS)
+#define LEDS_FUNCS(_leds)                                                                          \
+	(COND_CODE_1(CONFIG_LED_STRIP, (&app_led_strip_funcs),                                     \
+		     (COND_CODE_1(CONFIG_LED_PWM, (&app_led_pwm_funcs), (&app_led_gpio_funcs)))))
+#else
+#define LEDS_FUNCS(_leds) ((_leds)->funcs)
+#endif
+
+/* Start a frame; call with mutex held */
+static inline void leds_begin_frame(app_led_data_t *leds)
+{
+	if (LEDS_FUNCS(leds)->begin_frame != NULL) {
+		LEDS_FUNCS(leds)->begin_frame(leds);
+	}
+}
+
+/* Commit the frame to the backend if anything changed; call with mutex held */
+static inline int leds_commit(app_led_data_t *leds)
+{
+	return leds->dirty_end != 0 ? LEDS_FUNCS(leds)->commit(leds) : 0;
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+/* True while app_led_update is compositing a layer rather than writing to the backend */
+static inline bool leds_composing(const app_led_data_t *leds)
+{
+	return leds->layer >= 0;
+}
+
+/* Combine channel src of the layer being composited with dst below it */
+static inline uint8_t leds_blend8(uint8_t dst, uint8_t src, const struct app_led_layer_cfg *cfg)
+{
+	switch (cfg->blend) {
+	case APP_LED_BLEND_ADD:
+		return MIN(UINT8_MAX, dst + app_led_scale8(src, cfg->alpha));
+	case APP_LED_BLEND_LIGHTEN:
+		return MAX(dst, app_led_scale8(src, cfg->alpha));
+	default:
+		return app_led_div255(src * cfg->alpha + dst * (255 - cfg->alpha));
+	}
+}
+
+/* Blend pixels [start, end) at brightness over the layer frame; call with mutex held
+ *
+ * Colours are scaled by brightness here as each layer can have its own, so the composited frame is
+ * written to the backend at full brightness.
+ */
+static void leds_layer_write_span(app_led_data_t *leds, uint16_t start, uint16_t end,
+				  const rgb_color_t *c, size_t stride, uint8_t brightness)
+{
+	const struct app_led_layer_cfg *cfg = &leds->layers[leds->layer];
+	rgb_color_t *dst = &leds->layer_frame[start];
+	rgb_color_t scaled;
+
+	scaled = app_led_scale_color(leds, *c, brightness);
+	for (int i = start; i < end; i++, c = app_led_span_next(c, stride), dst++) {
+		// only scale again if walking an array
+		if (stride != 0 && i != start) {
+			scaled = app_led_scale_color(leds, *c, brightness);
 		}
+		dst->r = leds_blend8(dst->r, scaled.r, cfg);
+		dst->g = leds_blend8(dst->g, scaled.g, cfg);
+		dst->b = leds_blend8(dst->b, scaled.b, cfg);
+	}
+}
+#else
+static inline bool leds_composing(const app_led_data_t *leds)
+{
+	return false;
+}
+#endif
+
+/* Render pixels [start, end) into the layer being composited, otherwise the backend; call with
+ * mutex held
+ */
+static inline int leds_write_span(app_led_data_t *leds, uint16_t start, uint16_t end,
+				  const rgb_color_t *c, size_t stride, uint8_t brightness)
+{
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	if (leds_composing(leds)) {
+		leds_layer_write_span(leds, start, end, c, stride, brightness);
+		return 0;
+	}
+#endif
+
+	return LEDS_FUNCS(leds)->write_span(leds, start, end, c, stride, brightness);
+}
+
+/* Write pixels [start, end) from c, advancing c by stride bytes for each pixel; stride 0 fills the
+ * range with *c
+ *
+ * The span is rendered under one lock and committed before returning, unless called from within
+ * app_led_update which commits once at the end of the frame.
+ */
+static int leds_write_pixels(app_led_data_t *leds, uint16_t start, uint16_t end,
+			     const rgb_color_t *c, size_t stride, uint8_t brightness,
+			     k_timeout_t block)
+{
+	int err;
+
+	if (start >= leds->num_leds || end > leds->num_leds) {
+		LOG_ERR("LED index out of range");
+		return -EINVAL;
+	}
+
+	if (k_mutex_lock(&leds->mutex, block) != 0) {
+		return -EBUSY;
+	}
+
+	if (!leds->in_update) {
+		leds_begin_frame(leds);
+	}
+
+	err = leds_write_span(leds, start, end, c, stride, brightness);
+
+	if (err == 0 && !leds->in_update) {
+		err = leds_commit(leds);
+	}
+
+	k_mutex_unlock(&leds->mutex);
+
+	return err;
+}
+
+static inline int leds_set_pixels(app_led_data_t *leds, uint16_t start, uint16_t end,
+				  rgb_color_t c, uint8_t brightness, k_timeout_t block)
+{
+	return leds_write_pixels(leds, start, end, &c, 0, brightness, block);
+}
+
+/* Set a single pixel on the LED strip */
+static inline int leds_set_pixel(app_led_data_t *leds, uint16_t i, rgb_color_t c,
+				 uint8_t brightness, k_timeout_t block)
+{
+	return leds_set_pixels(leds, i, i + 1, c, brightness, block);
+}
+
+/* Lock and start a frame that leds_batch_end commits once, so per pixel loops over long strips
+ * don't lock and commit for every pixel; *nested is set when already inside one
+ */
+static int leds_batch_begin(app_led_data_t *leds, k_timeout_t block, bool *nested)
+{
+	if (k_mutex_lock(&leds->mutex, block) != 0) {
+		return -EBUSY;
 	}
 
-	leds->state[i]._color = c;
+	*nested = leds->in_update;
+	if (!*nested) {
+		leds->in_update = true;
+		leds_begin_frame(leds);
+	}
 
 	return 0;
 }
 
-static int leds_set_pin_pixels(app_led_data_t *leds, uint16_t start, uint16_t end, rgb_color_t c,
-			       uint8_t brightness, k_timeout_t block)
+/* Commit the frame started by leds_batch_begin, unless nested, and unlock */
+static int leds_batch_end(app_led_data_t *leds, bool nested)
 {
-	int err;
+	int err = 0;
 
-	if (start < leds->num_leds && end <= leds->num_leds) {
-		// scale
-		c.r = (uint8_t)((uint16_t)c.r * brightness / 255);
-		c.g = (uint8_t)((uint16_t)c.g * brightness / 255);
-		c.b = (uint8_t)((uint16_t)c.b * brightness / 255);
+	if (!nested) {
+		leds->in_update = false;
+		err = leds_commit(leds);
+	}
 
-		for (int i = start; i < end; i++) {
-			err = leds_set_pin_pixel(leds, i, c, brightness, block);
+	k_mutex_unlock(&leds->mutex);
 
-			if (err != 0) {
-				return err;
-			}
-		}
-	} else {
-		LOG_ERR("LED index out of range");
-		return -EINVAL;
+	return err;
+}
+
+/* Pass done_pending to done_cb with the mutex released so the callback can use the API and is
+ * never run under the lock; completions within a frame are left for app_led_update to report
+ * once the frame is unlocked
+ */
+static void leds_report_done(app_led_data_t *leds)
+{
+	app_led_done_cb_t cb;
+	void *user_data;
+	uint32_t done;
+
+	if (k_mutex_lock(&leds->mutex, K_FOREVER) != 0) {
+		return;
 	}
 
-	// TODO this is legacy and not representative of the actual color if changing sector
-	// it's just used for toggle whole strip
-	leds->_color = c;
+	// in_update is only seen set here when this thread is inside the frame
+	done = leds->in_update ? 0 : leds->done_pending;
+	leds->done_pending &= ~done;
+	cb = leds->done_cb;
+	user_data = leds->done_cb_user_data;
+	k_mutex_unlock(&leds->mutex);
 
-	return 0;
+	if (done != 0 && cb != NULL) {
+		cb(leds, done, user_data);
+	}
 }
 
-static int leds_set_pixels(app_led_data_t *leds, uint16_t start, uint16_t end, rgb_color_t c,
-			   uint8_t brightness, k_timeout_t block)
+/* Render pixels [start, end) with c within a batch, no range check or lock */
+static inline int leds_batch_fill(app_led_data_t *leds, uint16_t start, uint16_t end,
+				  rgb_color_t c, uint8_t brightness)
 {
-	switch (leds->hw_type) {
-#if IS_ENABLED(CONFIG_LED_STRIP)
-	case APP_LED_TYPE_STRIP:
-		return led_set_strip_pixels(leds, start, end, c, brightness, block);
-#endif
-#if IS_ENABLED(CONFIG_LED_PWM)
-	case APP_LED_TYPE_PWM:
-#endif
-#if IS_ENABLED(CONFIG_LED_GPIO)
-	case APP_LED_TYPE_GPIO:
-#endif
-		return leds_set_pin_pixels(leds, start, end, c, brightness, block);
-	default:
-		LOG_ERR("Unsupported LED type: should not be here!");
-		return -EINVAL;
-	}
+	return leds_write_span(leds, start, end, &c, 0, brightness);
 }
 
-/* Set a single pixel on the LED strip */
-static inline int leds_set_pixel(app_led_data_t *leds, uint16_t i, rgb_color_t c,
-				 uint8_t brightness, k_timeout_t block)
+/* Colour pixel i is showing, before gamma; palette strips read it from the palette and with
+ * CONFIG_APP_LED_SINGLE_STORE it is read back from the strip back buffer or channel frame, where a
+ * single colour LED only keeps its grey level
+ */
+static inline rgb_color_t leds_shown_color(const app_led_data_t *leds, uint16_t i)
 {
-	return leds_set_pixels(leds, i, i + 1, c, brightness, block);
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE)
+	if (leds->palette_frame != NULL) {
+		return app_led_scale_color(leds, leds->palette[leds_palette_get(leds, i)],
+					   leds->palette_brightness);
+	}
+#endif
+#if IS_ENABLED(CONFIG_APP_LED_SINGLE_STORE)
+	const uint8_t *ch;
+
+#if IS_ENABLED(CONFIG_LED_STRIP)
+	if (leds->channels == NULL) {
+		const struct led_rgb *px = &leds_strip_back(leds)[i];
+
+		return RGB(px->r, px->g, px->b);
+	}
+#endif
+	ch = &leds->channels[leds->is_rgb ? i * 3 : i];
+
+	return leds->is_rgb ? RGB(ch[0], ch[1], ch[2]) : RGB(ch[0], ch[0], ch[0]);
+#else
+	return leds->state[i]._color;
+#endif
 }
 
 /* Get the current set RGB value of a pixel as a rgb_color_t */
 int app_led_get_pixel_rgb(const app_led_data_t *const leds, uint16_t i, rgb_color_t *c)
 {
 	if (i < leds->num_leds) {
-		*c = leds->state[i]._color;
+		*c = leds_shown_color(leds, i);
 		return 0;
 	} else {
 		return -EINVAL;
@@ -365,9 +1391,9 @@ rgb_color_t app_led_hue_to_rgb(uint8_t hue)
 /* Blend two colors by a percentage */
 void blend_color(rgb_color_t *c1, const rgb_color_t *c2, uint8_t blend)
 {
-	c1->r = (c1->r * blend + c2->r * (255 - blend)) / 255;
-	c1->g = (c1->g * blend + c2->g * (255 - blend)) / 255;
-	c1->b = (c1->b * blend + c2->b * (255 - blend)) / 255;
+	c1->r = app_led_div255(c1->r * blend + c2->r * (255 - blend));
+	c1->g = app_led_div255(c1->g * blend + c2->g * (255 - blend));
+	c1->b = app_led_div255(c1->b * blend + c2->b * (255 - blend));
 }
 
 /* Fade a color to a target color by a step amount
@@ -400,6 +1426,75 @@ void fade_color(rgb_color_t *c, const rgb_color_t *target, uint8_t step)
 	}
 }
 
+/* Effect kernels
+ *
+ * Work on a span of the frame in one pass with a single backend write, rather than reading and
+ * writing each pixel through the setters which scale and lock per pixel. New colours are kept in
+ * state[].color, which is walked in place as the source of the span; blink colours are kept apart
+ * so effects under a blink do not change them. Call within a batch.
+ */
+
+/* Move channel v toward t by at most step */
+static inline uint8_t leds_step8(uint8_t v, uint8_t t, uint8_t step)
+{
+	return v > t ? MAX(v - step, t) : MIN(v + step, t);
+}
+
+/* Write state colours [start, end) at the global brightness */
+static inline int leds_fx_write(app_led_data_t *leds, uint16_t start, uint16_t end)
+{
+	return leds_write_span(leds, start, end, &leds->state[start].color,
+			       sizeof(struct app_led_state), leds->global_brightness);
+}
+
+/* Colour an effect continues from: the shown colour, or while compositing the layer's own last
+ * frame in state[].color so layers shown over it do not leak into it
+ */
+static inline rgb_color_t leds_fx_source(const app_led_data_t *leds, uint16_t i)
+{
+	return leds_composing(leds) ? leds->state[i].color : leds_shown_color(leds, i);
+}
+
+/* Fade pixels [start, end) toward target by step per channel, as fade_color */
+static int leds_fx_fade_toward(app_led_data_t *leds, uint16_t start, uint16_t end,
+			       rgb_color_t target, uint8_t step)
+{
+	rgb_color_t c;
+
+	for (uint16_t i = start; i < end; i++) {
+		c = leds_fx_source(leds, i);
+		leds->state[i].color = RGB(leds_step8(c.r, target.r, step),
+					   leds_step8(c.g, target.g, step),
+					   leds_step8(c.b, target.b, step));
+	}
+
+	return leds_fx_write(leds, start, end);
+}
+
+/* Blend pixels [start, end) with c, keeping blend / 255 of the current colour as blend_color; c
+ * black scales them
+ */
+static int leds_fx_blend(app_led_data_t *leds, uint16_t start, uint16_t end, rgb_color_t c,
+			 uint8_t blend)
+{
+	for (uint16_t i = start; i < end; i++) {
+		leds->state[i].color = leds_fx_source(leds, i);
+		blend_color(&leds->state[i].color, &c, blend);
+	}
+
+	return leds_fx_write(leds, start, end);
+}
+
+/* Fill pixels [start, end) with c */
+static int leds_fx_fill(app_led_data_t *leds, uint16_t start, uint16_t end, rgb_color_t c)
+{
+	for (uint16_t i = start; i < end; i++) {
+		leds->state[i].color = c;
+	}
+
+	return leds_batch_fill(leds, start, end, c, leds->global_brightness);
+}
+
 /* Set the color of a single LED at position i */
 int app_led_set_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_timeout_t block)
 {
@@ -415,6 +1510,141 @@ int app_led_set_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_timeout
 	return leds_set_pixel(leds, i, c, leds->global_brightness, block);
 }
 
+/* Set the color of LEDs [start, start + n) from an array under one lock and commit */
+int app_led_set_range(app_led_data_t *leds, uint16_t start, const rgb_color_t *c, uint16_t n,
+		      k_timeout_t block)
+{
+	int err;
+
+	if (start >= leds->num_leds || n > leds->num_leds - start)
+		return -EINVAL;
+
+	if (n == 0)
+		return 0;
+
+	if (k_mutex_lock(&leds->mutex, block) != 0)
+		return -EBUSY;
+
+	for (int i = 0; i < n; i++) {
+		leds->state[start + i].color = c[i];
+	}
+	err = leds_write_pixels(leds, start, start + n, c, sizeof(*c), leds->global_brightness,
+				block);
+
+	k_mutex_unlock(&leds->mutex);
+
+	return err;
+}
+
+/* Fill LEDs [start, start + n) with one color under one lock and commit */
+int app_led_fill_range(app_led_data_t *leds, uint16_t start, uint16_t n, rgb_color_t c,
+		       k_timeout_t block)
+{
+	int err;
+
+	if (start >= leds->num_leds || n > leds->num_leds - start)
+		return -EINVAL;
+
+	if (n == 0)
+		return 0;
+
+	if (k_mutex_lock(&leds->mutex, block) != 0)
+		return -EBUSY;
+
+	for (int i = start; i < start + n; i++) {
+		leds->state[i].color = c;
+	}
+	err = leds_set_pixels(leds, start, start + n, c, leds->global_brightness, block);
+
+	k_mutex_unlock(&leds->mutex);
+
+	return err;
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE)
+/* Set palette entries [first, first + n) of a palette strip; pixels using them change colour on
+ * the next flush without being rewritten
+ */
+int app_led_palette_set(app_led_data_t *leds, uint16_t first, const rgb_color_t *c, uint16_t n,
+			k_timeout_t block)
+{
+	bool nested;
+
+	if (leds->palette_frame == NULL)
+		return -ENOTSUP;
+
+	if (first >= APP_LED_PALETTE_SIZE || n > APP_LED_PALETTE_SIZE - first)
+		return -EINVAL;
+
+	if (leds_batch_begin(leds, block, &nested) != 0)
+		return -EBUSY;
+
+	memcpy(&leds->palette[first], c, n * sizeof(rgb_color_t));
+	leds_palette_brightness(leds, leds->global_brightness);
+	leds->palette_len = MAX(leds->palette_len, first + n);
+	leds->palette_fixed = MAX(leds->palette_fixed, first + n);
+	leds->dirty_start = 0;
+	leds->dirty_end = leds->hw_num_leds;
+
+	return leds_batch_end(leds, nested);
+}
+
+/* Rotate palette entries [first, first + n) down by one, the first moving to the end; cost is
+ * O(n) in the palette rather than the pixels, plus the flush
+ */
+int app_led_palette_rotate(app_led_data_t *leds, uint16_t first, uint16_t n, k_timeout_t block)
+{
+	rgb_color_t head;
+	bool nested;
+
+	if (leds->palette_frame == NULL)
+		return -ENOTSUP;
+
+	if (first >= leds->palette_len || n > leds->palette_len - first)
+		return -EINVAL;
+
+	if (n < 2)
+		return 0;
+
+	if (leds_batch_begin(leds, block, &nested) != 0)
+		return -EBUSY;
+
+	head = leds->palette[first];
+	memmove(&leds->palette[first], &leds->palette[first + 1], (n - 1) * sizeof(rgb_color_t));
+	leds->palette[first + n - 1] = head;
+	leds->dirty_start = 0;
+	leds->dirty_end = leds->hw_num_leds;
+
+	return leds_batch_end(leds, nested);
+}
+
+/* Fill LEDs [start, start + n) of a palette strip with a palette entry */
+int app_led_fill_palette_range(app_led_data_t *leds, uint16_t start, uint16_t n, uint8_t index,
+			       k_timeout_t block)
+{
+	bool nested;
+
+	if (leds->palette_frame == NULL)
+		return -ENOTSUP;
+
+	if (start >= leds->num_leds || n > leds->num_leds - start || index >= leds->palette_len)
+		return -EINVAL;
+
+	if (leds_batch_begin(leds, block, &nested) != 0)
+		return -EBUSY;
+
+	for (uint16_t i = start; i < start + n; i++) {
+		leds->state[i].color = leds->palette[index];
+		if (leds_palette_get(leds, i) != index) {
+			leds_palette_put(leds, i, index);
+			app_led_mark_dirty(leds, i);
+		}
+	}
+
+	return leds_batch_end(leds, nested);
+}
+#endif
+
 /* Set the color of all LEDs outside of a sequence/blink state; the fallback
  * color */
 int app_led_set_global_color(app_led_data_t *leds, rgb_color_t c, k_timeout_t block)
@@ -436,6 +1666,7 @@ int app_led_set_global_brightness(app_led_data_t *leds, uint8_t brightness, k_ti
 {
 	if (k_mutex_lock(&leds->mutex, block) == 0) {
 		leds->global_brightness = brightness;
+		IF_ENABLED(CONFIG_APP_LED_BRIGHTNESS_LUT, (leds_build_scale_lut(leds, brightness);))
 		k_mutex_unlock(&leds->mutex);
 	}
 
@@ -453,32 +1684,148 @@ int app_led_set_global_brightness(app_led_data_t *leds, uint8_t brightness, k_ti
  * */
 void app_led_fade_color(app_led_data_t *leds, uint8_t step, rgb_color_t target, k_timeout_t block)
 {
-	rgb_color_t update;
+	bool nested;
 
-	for (int i = 0; i < leds->num_leds; i++) {
-		app_led_get_pixel_rgb(leds, i, &update);
-		fade_color(&update, &target, step);
-		leds->state[i].color = update;
-		leds_set_pixel(leds, i, update, leds->global_brightness, block);
+	if (leds_batch_begin(leds, block, &nested) != 0) {
+		return;
 	}
+
+	leds_fx_fade_toward(leds, 0, leds->num_leds, target, step);
+
+	leds_batch_end(leds, nested);
 }
 
 /* Blend all LEDs to a target color by a percentage */
 void app_led_blend(app_led_data_t *leds, rgb_color_t c, uint8_t blend, k_timeout_t block)
 {
-	rgb_color_t update;
+	bool nested;
+
+	if (leds_batch_begin(leds, block, &nested) != 0) {
+		return;
+	}
+
+	leds_fx_blend(leds, 0, leds->num_leds, c, blend);
+
+	leds_batch_end(leds, nested);
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+#define LEDS_OVERLAYS                                                                              \
+	(BIT(APP_LED_LAYER_SEQUENCE) | BIT(APP_LED_LAYER_BLINK) | BIT(APP_LED_LAYER_ERROR))
+
+/* Manual or Rainbow, shown by the base layer */
+static inline LedMode leds_base_mode(const app_led_data_t *leds)
+{
+	if (leds->mode == Manual || leds->mode == Rainbow) {
+		return leds->mode;
+	}
+
+	return leds->rainbow ? Rainbow : Manual;
+}
+
+/* Mode of the top active layer */
+static LedMode leds_layers_mode(const app_led_data_t *leds)
+{
+	if (leds->layers_active & BIT(APP_LED_LAYER_ERROR)) {
+		return Error;
+	} else if (leds->layers_active & BIT(APP_LED_LAYER_BLINK)) {
+		return Blink;
+	} else if (leds->layers_active & BIT(APP_LED_LAYER_SEQUENCE)) {
+		return Sequence;
+	}
+
+	return leds_base_mode(leds);
+}
+
+/* Set and clear BIT(app_led_layer) bits of the active layers; returns the APP_LED_DONE_x of the
+ * sequence and blink layers cleared. Call with mutex held
+ */
+static uint32_t leds_layers_change(app_led_data_t *leds, uint8_t set, uint8_t clear)
+{
+	uint8_t ended = leds->layers_active & clear;
+
+	leds->layers_active = (leds->layers_active & ~clear) | set;
+
+	return ((ended & BIT(APP_LED_LAYER_SEQUENCE)) ? APP_LED_DONE_SEQUENCE : 0) |
+	       ((ended & BIT(APP_LED_LAYER_BLINK)) ? APP_LED_DONE_BLINK : 0);
+}
+
+/* Apply mode to the layers: Sequence, Blink and Error are added over the layers below and the mode
+ * becomes the top one, Manual and Rainbow clear them and Off keeps them for when it is left.
+ * Returns as leds_layers_change; call with mutex held
+ */
+static uint32_t leds_layers_set_mode(app_led_data_t *leds, LedMode mode)
+{
+	uint32_t done;
+
+	switch (mode) {
+	case Sequence:
+		done = leds_layers_change(leds, BIT(APP_LED_LAYER_SEQUENCE), 0);
+		break;
+	case Blink:
+		done = leds_layers_change(leds, BIT(APP_LED_LAYER_BLINK), 0);
+		break;
+	case Error:
+		done = leds_layers_change(leds, BIT(APP_LED_LAYER_ERROR), 0);
+		break;
+	case Manual:
+	case Rainbow:
+		done = leds_layers_change(leds, 0, LEDS_OVERLAYS);
+		break;
+	default:
+		return 0;
+	}
+
+	leds->mode = leds_layers_mode(leds);
+
+	return done;
+}
+
+/* Clear an overlay that has ended, which doesn't change the mode if another is shown over it, and
+ * wake any app_led_wait_x()
+ */
+static void leds_layer_end(app_led_data_t *leds, enum app_led_layer layer, k_timeout_t block)
+{
+	uint32_t done = 0;
+
+	if (k_mutex_lock(&leds->mutex, block) == 0) {
+		done = leds_layers_change(leds, 0, BIT(layer));
+		leds->done_pending |= done;
+		k_condvar_broadcast(&leds->done);
+		k_mutex_unlock(&leds->mutex);
+	}
 
-	for (int i = 0; i < leds->num_leds; i++) {
-		app_led_get_pixel_rgb(leds, i, &update);
-		blend_color(&update, &c, blend);
-		leds->state[i].color = update;
-		leds_set_pixel(leds, i, update, leds->global_brightness, block);
+	if (done != 0) {
+		leds_report_done(leds);
 	}
 }
+#endif
+
+/* Set the alpha and blend mode a layer is composited with */
+int app_led_layer_set(app_led_data_t *leds, enum app_led_layer layer, uint8_t alpha,
+		      enum app_led_blend_mode blend, k_timeout_t block)
+{
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	if (layer >= APP_LED_NUM_LAYERS || blend > APP_LED_BLEND_LIGHTEN)
+		return -EINVAL;
+
+	if (k_mutex_lock(&leds->mutex, block) != 0)
+		return -EBUSY;
+
+	leds->layers[layer] = (struct app_led_layer_cfg){.alpha = alpha, .blend = blend};
+	k_mutex_unlock(&leds->mutex);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
 
 /* Set the LedMode of the App LED */
 void app_led_set_mode(app_led_data_t *leds, LedMode mode, k_timeout_t block)
 {
+	uint32_t done = 0;
+
 	// if not already in requested mode to avoid replacing last_mode
 	if (leds->mode != mode) {
 		if (k_mutex_lock(&leds->mutex, block) == 0) {
@@ -487,21 +1834,43 @@ void app_led_set_mode(app_led_data_t *leds, LedMode mode, k_timeout_t block)
 			if (leds->mode == Rainbow) {
 				leds->rainbow = true;
 			}
+
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+			// an overlay is only complete when its layer is cleared
+			done = leds_layers_set_mode(leds, mode);
+#else
+			// leaving a mode completes it; wake any app_led_wait_x()
+			if (leds->last_mode == Sequence) {
+				done = APP_LED_DONE_SEQUENCE;
+			} else if (leds->last_mode == Blink) {
+				done = APP_LED_DONE_BLINK;
+			}
+#endif
+			leds->done_pending |= done;
+			k_condvar_broadcast(&leds->done);
 			k_mutex_unlock(&leds->mutex);
 		}
 	}
 
+	if (done != 0) {
+		leds_report_done(leds);
+	}
+
 	// act on change
 	switch (mode) {
 	case Manual:
-		leds_set_pixels(leds, 0, leds->num_leds, leds->global_color,
-				leds->global_brightness, block);
+		// a layer ending while composited leaves the colour to the base layer, which drew it
+		// this frame, rather than drawing it into the layer
+		if (!leds_composing(leds)) {
+			leds_set_pixels(leds, 0, leds->num_leds, leds->global_color,
+					leds->global_brightness, block);
+		}
 		/* intentional fallthrough */
 	case Off:
-		IF_ENABLED(CONFIG_APP_LED_SUSPEND_TASK_MANUAL, (k_work_cancel_delayable(&leds->dwork);))
+		IF_ENABLED(CONFIG_APP_LED_SUSPEND_TASK_MANUAL, (leds_suspend(leds);))
 		break;
 	default:
-		IF_ENABLED(CONFIG_APP_LED_SUSPEND_TASK_MANUAL, (k_work_schedule(&leds->dwork, K_NO_WAIT);))
+		IF_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE, (leds_wake(leds);))
 		break;
 	}
 }
@@ -509,8 +1878,24 @@ void app_led_set_mode(app_led_data_t *leds, LedMode mode, k_timeout_t block)
 /* Return to last mode */
 void app_led_last_mode(app_led_data_t *leds, k_timeout_t block)
 {
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	LedMode top;
+
+	if (k_mutex_lock(&leds->mutex, block) != 0) {
+		return;
+	}
+
+	// leaving an error drops its layer; whatever is still active under it is shown
+	if (leds->mode == Error) {
+		leds_layers_change(leds, 0, BIT(APP_LED_LAYER_ERROR));
+	}
+	top = leds_layers_mode(leds);
+	k_mutex_unlock(&leds->mutex);
+
+	app_led_set_mode(leds, top, block);
+#else
 	int64_t now = k_uptime_get();
-	struct app_led_state *led;
+	struct app_led_blink *led;
 	LedMode last = leds->last_mode;
 
 	switch (leds->last_mode) {
@@ -524,8 +1909,8 @@ void app_led_last_mode(app_led_data_t *leds, k_timeout_t block)
 		}
 
 		// loop through, any blinking will set to return to blink
-		for (int i = 0; i < leds->num_leds; i++) {
-			led = &leds->state[i];
+		for (int i = 0; IS_ENABLED(CONFIG_APP_LED_BLINK) && i < leds->num_leds; i++) {
+			led = &leds->blink[i];
 			if ((led->on_time_ms_left < now) && (led->off_time_ms_left < now)) {
 				last = Blink;
 			}
@@ -533,7 +1918,7 @@ void app_led_last_mode(app_led_data_t *leds, k_timeout_t block)
 		break;
 	case Sequence:
 		// if sequence finished, return to manual/rainbow
-		if (leds->sequence == NULL) {
+		if (leds->sequence == NULL && leds->keyframes == NULL) {
 			if (leds->rainbow) {
 				last = Rainbow;
 			} else {
@@ -547,6 +1932,7 @@ void app_led_last_mode(app_led_data_t *leds, k_timeout_t block)
 	}
 
 	app_led_set_mode(leds, last, block);
+#endif
 }
 
 int app_led_toggle_index_color(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_timeout_t block)
@@ -608,29 +1994,43 @@ int app_led_off(app_led_data_t *leds, k_timeout_t block)
 	return app_led_set_global_color(leds, RGBHEX(Black), block);
 }
 
-// blink led with on_period and off_period in ms. state_override flag will
-// prevent blinking if in Off, Sequence or Error state
-int app_led_blink_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, uint32_t on_period_ms,
-			uint32_t off_period_ms, bool state_override, k_timeout_t block)
+/* Colour a blinking LED shows; without layers the blink borrows the state colour */
+static inline rgb_color_t *leds_blink_color(app_led_data_t *leds, uint16_t i)
+{
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	return &leds->blink[i].color;
+#else
+	return &leds->state[i].color;
+#endif
+}
+
+/* Start LEDs [start, end) blinking that are not already, under one lock with one mode change */
+static int leds_blink_range(app_led_data_t *leds, uint16_t start, uint16_t end, rgb_color_t c,
+			    uint32_t on_period_ms, uint32_t off_period_ms, bool state_override,
+			    k_timeout_t block)
 {
 	int64_t now = k_uptime_get();
 	bool change_mode = false;
-	struct app_led_state *led;
+	struct app_led_blink *led;
 
-	if (i >= leds->num_leds)
-		return -EINVAL;
+	if (!IS_ENABLED(CONFIG_APP_LED_BLINK))
+		return -ENOTSUP;
 
-	if (!state_override && (leds->mode == Sequence || leds->mode == Off || leds->mode == Error))
+	// with layers a blink is shown over a sequence rather than replacing it
+	if (!state_override && ((leds->mode == Sequence && !IS_ENABLED(CONFIG_APP_LED_LAYERS)) ||
+				leds->mode == Off || leds->mode == Error))
 		return -EALREADY;
 
 	if (k_mutex_lock(&leds->mutex, block) == 0) {
-		led = &leds->state[i];
+		for (uint16_t i = start; i < end; i++) {
+			led = &leds->blink[i];
 
-		if ((led->on_time_ms_left < now) && (led->off_time_ms_left < now)) {
-			led->off_time_ms_left = now + on_period_ms + off_period_ms;
-			led->on_time_ms_left = now + on_period_ms;
-			led->color = c;
-			change_mode = true;
+			if ((led->on_time_ms_left < now) && (led->off_time_ms_left < now)) {
+				led->off_time_ms_left = now + on_period_ms + off_period_ms;
+				led->on_time_ms_left = now + on_period_ms;
+				*leds_blink_color(leds, i) = c;
+				change_mode = true;
+			}
 		}
 		k_mutex_unlock(&leds->mutex);
 	}
@@ -642,25 +2042,32 @@ int app_led_blink_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, uint32_
 	return 0;
 }
 
-int app_led_blink(app_led_data_t *leds, rgb_color_t c, uint32_t on_period_ms,
-		  uint32_t off_period_ms, bool state_override, k_timeout_t block)
+// blink led with on_period and off_period in ms. state_override flag will
+// prevent blinking if in Off, Sequence or Error state
+int app_led_blink_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, uint32_t on_period_ms,
+			uint32_t off_period_ms, bool state_override, k_timeout_t block)
 {
-	int err = 0;
+	if (i >= leds->num_leds)
+		return -EINVAL;
 
-	for (int i = 0; i < leds->num_leds; i++) {
-		err = app_led_blink_index(leds, i, c, on_period_ms, off_period_ms, state_override,
-					  block);
-		if (err != 0)
-			break;
-	}
+	return leds_blink_range(leds, i, i + 1, c, on_period_ms, off_period_ms, state_override,
+				block);
+}
 
-	return err;
+int app_led_blink(app_led_data_t *leds, rgb_color_t c, uint32_t on_period_ms,
+		  uint32_t off_period_ms, bool state_override, k_timeout_t block)
+{
+	return leds_blink_range(leds, 0, leds->num_leds, c, on_period_ms, off_period_ms,
+				state_override, block);
 }
 
 // used to sync blink when changing colour
 int app_led_blink_sync_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_timeout_t block)
 {
-	struct app_led_state *led;
+	struct app_led_blink *led;
+
+	if (!IS_ENABLED(CONFIG_APP_LED_BLINK))
+		return -ENOTSUP;
 
 	if (i >= leds->num_leds) {
 		LOG_ERR("LED index out of range");
@@ -668,13 +2075,15 @@ int app_led_blink_sync_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_
 	}
 
 	if (k_mutex_lock(&leds->mutex, block) == 0) {
-		led = &leds->state[i];
+		led = &leds->blink[i];
 		led->off_time_ms_left = 0;
 		led->on_time_ms_left = 0;
-		led->color = c;
+		leds->state[i].color = c;
 		k_mutex_unlock(&leds->mutex);
 	}
 
+	IF_ENABLED(CONFIG_APP_LED_LAYERS, (leds_layer_end(leds, APP_LED_LAYER_BLINK, block);))
+
 	// put back if was in blink mode
 	if (leds->mode == Blink) {
 		app_led_last_mode(leds, block);
@@ -685,29 +2094,73 @@ int app_led_blink_sync_index(app_led_data_t *leds, uint16_t i, rgb_color_t c, k_
 
 int app_led_blink_sync(app_led_data_t *leds, rgb_color_t c, k_timeout_t block)
 {
-	int err = 0;
+	struct app_led_blink *led;
 
-	for (int i = 0; i < leds->num_leds; i++) {
-		err = app_led_blink_sync_index(leds, i, c, block);
-		if (err != 0)
-			break;
+	if (!IS_ENABLED(CONFIG_APP_LED_BLINK))
+		return -ENOTSUP;
+
+	if (k_mutex_lock(&leds->mutex, block) == 0) {
+		for (uint16_t i = 0; i < leds->num_leds; i++) {
+			led = &leds->blink[i];
+			led->off_time_ms_left = 0;
+			led->on_time_ms_left = 0;
+			leds->state[i].color = c;
+		}
+		k_mutex_unlock(&leds->mutex);
 	}
 
-	return err;
+	IF_ENABLED(CONFIG_APP_LED_LAYERS, (leds_layer_end(leds, APP_LED_LAYER_BLINK, block);))
+
+	// put back if was in blink mode
+	if (leds->mode == Blink) {
+		app_led_last_mode(leds, block);
+	}
+
+	return 0;
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE)
+static void leds_sequence_cache_render(app_led_data_t *leds);
+#endif
+
+/* Replace the running sequence with a step table or keyframes starting now; call with mutex held */
+static void leds_sequence_start(app_led_data_t *leds, const app_led_sequence_step_t *sequence,
+				const app_led_keyframe_t *keyframes, int8_t num_repeat)
+{
+	IF_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE, (leds->sequence_cache_len = 0;))
+	leds->sequence = sequence;
+	leds->keyframes = keyframes;
+	leds->sequence_repeat_count = num_repeat;
+	leds->sequence_step = 0;
+	// the first step is due now
+	leds->sequence_data.step_start = k_uptime_get();
+	leds->sequence_data.step_ms = 0;
 }
 
 int app_led_fade_to(app_led_data_t *leds, rgb_color_t c, uint8_t end_brightness,
 		    uint32_t fade_time_ms, k_timeout_t block)
 {
-	app_led_fade_sequence[0].color = leds->global_color;
-	app_led_fade_sequence[0].start_brightness = leds->global_brightness;
-	app_led_fade_sequence[0].end_brightness = 0;
-	app_led_fade_sequence[0].time_in_10ms = fade_time_ms / 10;
-	app_led_fade_sequence[1].color = c;
-	app_led_fade_sequence[1].start_brightness = end_brightness;
-	app_led_fade_sequence[1].end_brightness = end_brightness;
-	app_led_run_sequence(leds, app_led_fade_sequence, 0, block);
-	// do this after starting sequence so gets set in background
+	if (k_mutex_lock(&leds->mutex, block) != 0) {
+		return -EBUSY;
+	}
+
+	// the fade keyframes belong to leds so instances fading at once don't share state
+	leds->fade[0] = (app_led_keyframe_t){
+		.color = leds->global_color,
+		.brightness = leds->global_brightness,
+		.duration_ms = fade_time_ms,
+	};
+	leds->fade[1] = (app_led_keyframe_t){
+		.color = c,
+		.brightness = end_brightness,
+		.duration_ms = APP_LED_KEYFRAME_END,
+	};
+	leds_sequence_start(leds, NULL, leds->fade, 0);
+	k_mutex_unlock(&leds->mutex);
+
+	// after unlocking so a blink or sequence ended by the fade reports done without the lock
+	app_led_set_mode(leds, Sequence, block);
+	// do this after starting the fade so it is shown once the fade ends
 	app_led_set_global_color(leds, c, block);
 	app_led_set_global_brightness(leds, end_brightness, block);
 
@@ -731,9 +2184,19 @@ void app_led_run_sequence(app_led_data_t *leds, const app_led_sequence_step_t *s
 			  int8_t num_repeat, k_timeout_t block)
 {
 	if (k_mutex_lock(&leds->mutex, block) == 0) {
-		leds->sequence = sequence;
-		leds->sequence_repeat_count = num_repeat;
-		leds->time_sequence_next = 0;
+		leds_sequence_start(leds, sequence, NULL, num_repeat);
+		IF_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE, (leds_sequence_cache_render(leds);))
+		k_mutex_unlock(&leds->mutex);
+	}
+
+	app_led_set_mode(leds, Sequence, block);
+}
+
+void app_led_run_keyframes(app_led_data_t *leds, const app_led_keyframe_t *keyframes,
+			   int8_t num_repeat, k_timeout_t block)
+{
+	if (k_mutex_lock(&leds->mutex, block) == 0) {
+		leds_sequence_start(leds, NULL, keyframes, num_repeat);
 		k_mutex_unlock(&leds->mutex);
 	}
 
@@ -745,53 +2208,117 @@ void app_led_sequence_clear(app_led_data_t *leds, k_timeout_t block)
 {
 	if (k_mutex_lock(&leds->mutex, block) == 0) {
 		leds->sequence = NULL;
+		leds->keyframes = NULL;
 		leds->sequence_step = 0;
 		leds->sequence_repeat_count = 0;
-		leds->time_sequence_next = 0;
+		IF_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE, (leds->sequence_cache_len = 0;))
 		k_mutex_unlock(&leds->mutex);
 	}
 
+	IF_ENABLED(CONFIG_APP_LED_LAYERS, (leds_layer_end(leds, APP_LED_LAYER_SEQUENCE, block);))
+
 	// put last mode back if sequence was running
 	if (leds->mode == Sequence) {
 		app_led_last_mode(leds, block);
 	}
 }
 
-/* Wait for sequence/blink to finish */
-void app_led_wait_inactive(app_led_data_t *leds, k_timeout_t timeout)
+/* BIT(LedMode) of the modes leds is running; with layers a sequence or blink under the mode shown
+ * is still running unless Off
+ */
+static inline uint32_t leds_running_modes(const app_led_data_t *leds)
+{
+	uint32_t modes = BIT(leds->mode);
+
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	if (leds->mode != Off) {
+		modes |= ((leds->layers_active & BIT(APP_LED_LAYER_SEQUENCE)) ? BIT(Sequence) : 0) |
+			 ((leds->layers_active & BIT(APP_LED_LAYER_BLINK)) ? BIT(Blink) : 0);
+	}
+#endif
+
+	return modes;
+}
+
+/* Set the buffer sequences are pre-rendered into, used from the next app_led_run_sequence */
+int app_led_set_sequence_cache(app_led_data_t *leds, rgb_color_t *cache, uint16_t len,
+			       k_timeout_t block)
+{
+#if IS_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE)
+	if (k_mutex_lock(&leds->mutex, block) != 0)
+		return -EBUSY;
+
+	leds->sequence_cache = cache;
+	leds->sequence_cache_size = cache != NULL ? len : 0;
+	// a running sequence keeps going from where it is without the cache
+	if (leds->sequence_cache_len != 0) {
+		leds->sequence_cache_len = 0;
+		leds->sequence_step = 0;
+		leds->sequence_data.step_ms = 0;
+	}
+	k_mutex_unlock(&leds->mutex);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+/* Block until leds is not in any of the modes in the BIT(LedMode) mask or timeout
+ *
+ * app_led_set_mode broadcasts on leds->done when the mode changes so waiters wake as soon as the
+ * sequence/blink ends rather than polling.
+ */
+static void leds_wait_mode_exit(app_led_data_t *leds, uint32_t modes, k_timeout_t timeout)
 {
 	k_timepoint_t end = sys_timepoint_calc(timeout);
 
-	do {
-		timeout = sys_timepoint_timeout(end);
-		k_sleep(K_MSEC(CONFIG_APP_LED_UPDATE_PERIOD));
-	} while (!K_TIMEOUT_EQ(timeout, K_NO_WAIT) &&
-		 (leds->mode == Sequence || leds->mode == Blink));
+	if (k_mutex_lock(&leds->mutex, timeout) != 0) {
+		return;
+	}
+
+	while ((leds_running_modes(leds) & modes) != 0) {
+		if (k_condvar_wait(&leds->done, &leds->mutex, sys_timepoint_timeout(end)) != 0) {
+			break;
+		}
+	}
+
+	k_mutex_unlock(&leds->mutex);
+}
+
+/* Wait for sequence/blink to finish */
+void app_led_wait_inactive(app_led_data_t *leds, k_timeout_t timeout)
+{
+	leds_wait_mode_exit(leds, BIT(Sequence) | BIT(Blink), timeout);
 }
 
 /* Wait for sequence to finish */
 void app_led_wait_sequence(app_led_data_t *leds, k_timeout_t timeout)
 {
-	k_timepoint_t end = sys_timepoint_calc(timeout);
-
-	do {
-		timeout = sys_timepoint_timeout(end);
-		k_sleep(K_MSEC(CONFIG_APP_LED_UPDATE_PERIOD));
-	} while (!K_TIMEOUT_EQ(timeout, K_NO_WAIT) && leds->mode == Sequence);
+	leds_wait_mode_exit(leds, BIT(Sequence), timeout);
 }
 
 /* Wait for blink to finish */
 void app_led_wait_blink(app_led_data_t *leds, k_timeout_t timeout)
 {
-	k_timepoint_t end = sys_timepoint_calc(timeout);
+	leds_wait_mode_exit(leds, BIT(Blink), timeout);
+}
 
-	do {
-		timeout = sys_timepoint_timeout(end);
-		k_sleep(K_MSEC(CONFIG_APP_LED_UPDATE_PERIOD));
-	} while (!K_TIMEOUT_EQ(timeout, K_NO_WAIT) && leds->mode == Blink);
+/* Set callback for sequence/blink completion */
+void app_led_set_done_callback(app_led_data_t *leds, app_led_done_cb_t cb, void *user_data)
+{
+	if (k_mutex_lock(&leds->mutex, K_FOREVER) == 0) {
+		leds->done_cb = cb;
+		leds->done_cb_user_data = user_data;
+		k_mutex_unlock(&leds->mutex);
+	}
 }
 
-/* Sequence function callbacks */
+/* Sequence function callbacks
+ *
+ * Called from app_led_update with the frame batched and mutex held, so effects render with the
+ * effect kernels directly.
+ */
 
 /* Generic sequence function to set step color to global color etc. */
 void app_led_seq_fnc(void *const pleds, const void *const pstep, k_timeout_t block)
@@ -825,233 +2352,609 @@ void app_led_chase(void *const pleds, const void *const pstep, k_timeout_t block
 	app_led_sequence_data_t *data = &leds->sequence_data;
 	data->color = leds->global_color;
 
-	app_led_fade_color(leds, 4, RGBHEX(Black), block);
+	leds_fx_fade_toward(leds, 0, leds->num_leds, RGBHEX(Black), 4);
+
+	if (k_uptime_get() - data->last_tick >= (step->time_in_10ms * 10) / leds->num_leds) {
+		if (data->count > leds->num_leds)
+			data->count = 0;
+
+		// head is off the end for a tick before wrapping
+		if (data->count < leds->num_leds) {
+			leds_fx_fill(leds, data->count, data->count + 1, data->color);
+		}
+		data->count++;
+		data->last_tick = k_uptime_get();
+	}
+}
+
+void app_led_fade_blink(void *const pleds, const void *const pstep, k_timeout_t block)
+{
+	app_led_data_t *leds = (app_led_data_t *)pleds;
+	app_led_sequence_step_t *step = (app_led_sequence_step_t *)pstep;
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	data->color = leds->global_color;
+
+	leds_fx_fade_toward(leds, 0, leds->num_leds, RGBHEX(Black), 16);
+
+	if (k_uptime_get() - data->last_tick >= (step->time_in_10ms * 10) / 2) {
+		leds_fx_fill(leds, 0, leds->num_leds, data->color);
+		data->last_tick = k_uptime_get();
+	}
+}
+
+void app_led_half_blink(void *const pleds, const void *const pstep, k_timeout_t block)
+{
+	app_led_data_t *leds = (app_led_data_t *)pleds;
+	app_led_sequence_step_t *step = (app_led_sequence_step_t *)pstep;
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	data->color = leds->global_color;
+
+	if (data->count) {
+		leds_fx_fade_toward(leds, leds->num_leds / 2, leds->num_leds, RGBHEX(Black), 16);
+		leds_fx_fill(leds, 0, leds->num_leds / 2, data->color);
+	}
+
+	if (k_uptime_get() - data->last_tick >= (step->time_in_10ms * 10) / 2) {
+		leds_fx_fill(leds, 0, leds->num_leds, data->color);
+		if (data->count == 0) {
+			data->count = 1;
+		} else {
+			data->count = 0;
+		}
+		data->last_tick = k_uptime_get();
+	}
+}
+
+void app_led_sine(void *const pleds, const void *const pstep, k_timeout_t block)
+{
+	app_led_data_t *leds = (app_led_data_t *)pleds;
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	uint16_t i;
+
+	data->color = leds->global_color;
+
+	leds_fx_fade_toward(leds, 0, leds->num_leds, RGBHEX(Black), 6);
+
+	if (k_uptime_get() - data->last_tick >= data->count * 10) {
+		if (data->count > leds->num_leds) {
+			data->count = 0;
+			leds->_toggle = !leds->_toggle;
+		}
+
+		i = leds->_toggle ? (leds->num_leds - ++data->count) : data->count++;
+		// runs a step past each end before turning
+		if (i < leds->num_leds) {
+			leds_fx_fill(leds, i, i + 1, data->color);
+		}
+		data->last_tick = k_uptime_get();
+	}
+}
+
+/* Interpolate from a to b by frac / APP_LED_FRAC_ONE */
+static inline rgb_color_t leds_lerp_color(rgb_color_t a, rgb_color_t b, uint32_t frac)
+{
+	return RGB(app_led_lerp8(a.r, b.r, frac), app_led_lerp8(a.g, b.g, frac),
+		   app_led_lerp8(a.b, b.b, frac));
+}
+
+/* Step table step being shown, NULL for keyframes or before the first step */
+static inline const app_led_sequence_step_t *leds_sequence_current(const app_led_data_t *leds)
+{
+	return leds->sequence != NULL && leds->sequence_step > 0
+		       ? &leds->sequence[leds->sequence_step - 1]
+		       : NULL;
+}
+
+/* True if the current step changes colour or brightness over its duration */
+static inline bool leds_sequence_fading(const app_led_sequence_data_t *data)
+{
+	return data->from.hex != data->to.hex || data->from_brightness != data->to_brightness;
+}
+
+/* Fraction of the current step elapsed at now */
+static uint32_t leds_sequence_frac(const app_led_sequence_data_t *data, int64_t now)
+{
+	int64_t elapsed = now - data->step_start;
+
+	if (elapsed >= data->step_ms) {
+		return APP_LED_FRAC_ONE;
+	} else if (elapsed <= 0) {
+		return 0;
+	}
+
+	return (uint32_t)(((uint64_t)elapsed << 16) / data->step_ms);
+}
+
+/* Load the next step of the running sequence to start at start; returns false if it is the last,
+ * which is held. Call with mutex held
+ *
+ * Step tables are run as keyframes: a step holds its colour and fades from its start brightness,
+ * clamped to the global brightness, to its end brightness over time_in_10ms.
+ */
+static bool leds_sequence_load(app_led_data_t *leds, int64_t start)
+{
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	const app_led_sequence_step_t *step;
+	const app_led_keyframe_t *kf;
+	bool last;
+
+	if (leds->sequence != NULL) {
+		step = &leds->sequence[leds->sequence_step];
+		last = step->time_in_10ms == 0xFF;
+		data->from = step->color;
+		data->to = step->color;
+		data->from_brightness = step->start_brightness > leds->global_brightness &&
+						leds->global_brightness != 0
+						? leds->global_brightness
+						: step->start_brightness;
+		data->to_brightness = last ? data->from_brightness : step->end_brightness;
+		data->step_ms = last ? 0 : 10U * step->time_in_10ms;
+	} else {
+		kf = &leds->keyframes[leds->sequence_step];
+		last = kf->duration_ms == APP_LED_KEYFRAME_END;
+		data->from = kf->color;
+		data->to = last ? kf->color : kf[1].color;
+		data->from_brightness = kf->brightness;
+		data->to_brightness = last ? kf->brightness : kf[1].brightness;
+		data->step_ms = last ? 0 : kf->duration_ms;
+	}
+	if (leds->sequence_step == 0) {
+		data->pass_start = start;
+	}
+	data->step_start = start;
+	leds->sequence_step++;
+
+	return !last;
+}
+
+/* Render the current step at frac; a step function is called every update and a static step is
+ * only written when it starts. Call with mutex held
+ */
+static void leds_sequence_render(app_led_data_t *leds, uint32_t frac, bool started,
+				 k_timeout_t block)
+{
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	const app_led_sequence_step_t *step = leds_sequence_current(leds);
+	bool fading = leds_sequence_fading(data);
+
+	data->color = leds_lerp_color(data->from, data->to, frac);
+	data->brightness = app_led_lerp8(data->from_brightness, data->to_brightness, frac);
+
+	if (step != NULL && step->fnc != NULL) {
+		step->fnc(leds, step, block);
+	} else {
+		// a composited layer starts empty each update so is always written
+		fading = fading || started || leds_composing(leds);
+	}
+
+	if (fading) {
+		leds_set_pixels(leds, 0, leds->num_leds, data->color, data->brightness, block);
+	}
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE)
+/* Pre-render one pass of the running step table into the sequence cache, sampled every update
+ * period as app_led_update_sequence would show it, with the held last step as the final entry.
+ * Left uncached if a step has a step function other than app_led_seq_fnc or the pass doesn't fit.
+ * Call with mutex held
+ *
+ * Entries are scaled by brightness so playback is a lookup and a fill at full brightness.
+ */
+static void leds_sequence_cache_render(app_led_data_t *leds)
+{
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	const app_led_sequence_step_t *step;
+	int64_t pass_start = data->step_start;
+	bool more = true;
+	uint32_t frac;
+	rgb_color_t c;
+	uint16_t n = 0;
+	int64_t t = 0;
+
+	leds->sequence_cache_len = 0;
+	if (leds->sequence_cache == NULL || leds->sequence == NULL) {
+		return;
+	}
+
+	for (step = leds->sequence; step->time_in_10ms != 0xFF; step++) {
+		if (step->fnc != NULL && step->fnc != app_led_seq_fnc) {
+			return;
+		}
+	}
+
+	// walk the steps from a pass starting at 0
+	leds->sequence_step = 0;
+	data->step_start = 0;
+	data->step_ms = 0;
+	while (n < leds->sequence_cache_size) {
+		while (more && t - data->step_start >= data->step_ms) {
+			more = leds_sequence_load(leds, data->step_start + data->step_ms);
+		}
+
+		frac = more ? leds_sequence_frac(data, t) : APP_LED_FRAC_ONE;
+		step = leds_sequence_current(leds);
+		// app_led_seq_fnc shows the global colour
+		c = step->fnc != NULL ? leds->global_color : leds_lerp_color(data->from, data->to, frac);
+		leds->sequence_cache[n++] = app_led_scale_color(
+			leds, c, app_led_lerp8(data->from_brightness, data->to_brightness, frac));
+
+		if (!more) {
+			leds->sequence_cache_len = n;
+			leds->sequence_cache_ms = (uint32_t)data->step_start;
+			break;
+		}
+		t += CONFIG_APP_LED_UPDATE_PERIOD;
+	}
+
+	leds->cache_color = leds->global_color;
+	leds->cache_brightness = leds->global_brightness;
+	// the live sequence starts over from the pass start if not cached
+	leds->sequence_step = 0;
+	data->step_start = pass_start;
+	data->step_ms = 0;
+}
+
+/* True if the running sequence plays from the cache, rendering it again if the global colour or
+ * brightness changed since it was rendered; call with mutex held
+ */
+static bool leds_sequence_cached(app_led_data_t *leds)
+{
+	if (leds->sequence_cache_len != 0 && (leds->cache_color.hex != leds->global_color.hex ||
+					      leds->cache_brightness != leds->global_brightness)) {
+		leds_sequence_cache_render(leds);
+	}
+
+	return leds->sequence_cache_len != 0;
+}
+
+/* Show the cached entry for now; returns true if the pass ended and the sequence is over. Call
+ * with mutex held
+ */
+static bool leds_sequence_cache_play(app_led_data_t *leds, int64_t now, k_timeout_t block)
+{
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	int64_t elapsed = now - data->step_start;
+
+	if (elapsed < leds->sequence_cache_ms) {
+		leds_set_pixels(leds, 0, leds->num_leds,
+				leds->sequence_cache[elapsed / CONFIG_APP_LED_UPDATE_PERIOD], 0xFF,
+				block);
+		return false;
+	}
+
+	// last step is shown then the pass repeats from when it was due, or ends
+	leds_set_pixels(leds, 0, leds->num_leds,
+			leds->sequence_cache[leds->sequence_cache_len - 1], 0xFF, block);
+	if (leds->sequence_repeat_count == 0) {
+		return true;
+	}
+	if (leds->sequence_repeat_count > 0) {
+		leds->sequence_repeat_count--;
+	}
+	data->step_start += leds->sequence_cache_ms;
+	// paused for longer than a pass so start the next one now
+	if (now - data->step_start >= leds->sequence_cache_ms) {
+		data->step_start = now;
+	}
+
+	return false;
+}
+#endif
+
+/* Run the sequence; called from app_led_update with the frame batched
+ *
+ * Colour and brightness are a function of the time since the step started, so a late update
+ * catches up rather than stretching the step and the update period can change without changing the
+ * animation speed. Steps that ended before now are passed over, each starting when the last was
+ * due to end.
+ */
+static void app_led_update_sequence(app_led_data_t *leds, k_timeout_t block)
+{
+	app_led_sequence_data_t *data = &leds->sequence_data;
+	int64_t now = k_uptime_get();
+	bool started = false;
+
+	if (k_mutex_lock(&leds->mutex, block) != 0) {
+		return;
+	}
+
+	if (leds->sequence == NULL && leds->keyframes == NULL) {
+		k_mutex_unlock(&leds->mutex);
+		app_led_sequence_clear(leds, block);
+		return;
+	}
+
+#if IS_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE)
+	if (leds_sequence_cached(leds)) {
+		bool ended = leds_sequence_cache_play(leds, now, block);
+
+		k_mutex_unlock(&leds->mutex);
+		if (ended) {
+			// sequence over so go back to last mode
+			app_led_sequence_clear(leds, block);
+		}
+		return;
+	}
+#endif
+
+	while (now - data->step_start >= data->step_ms) {
+		started = true;
+		if (leds_sequence_load(leds, data->step_start + data->step_ms)) {
+			continue;
+		}
+
+		// last step is shown then the sequence repeats from when it was due, or ends
+		leds_sequence_render(leds, APP_LED_FRAC_ONE, true, block);
+		if (leds->sequence_repeat_count == 0) {
+			k_mutex_unlock(&leds->mutex);
+			// sequence over so go back to last mode
+			app_led_sequence_clear(leds, block);
+			return;
+		}
+		// decrement if > 0 so we exit after count; -1 runs forever
+		if (leds->sequence_repeat_count > 0) {
+			leds->sequence_repeat_count--;
+		}
+		leds->sequence_step = 0;
+		// paused for longer than a pass, such as under a blink or in Manual, so the next pass
+		// starts now rather than catching up one pass an update
+		if (now - data->step_start >= data->step_start - data->pass_start) {
+			data->step_start = now;
+		}
+		k_mutex_unlock(&leds->mutex);
+		return;
+	}
+
+	leds_sequence_render(leds, leds_sequence_frac(data, now), started, block);
+
+	k_mutex_unlock(&leds->mutex);
+}
+
+/* Render a run of LEDs in the same blink state; composited LEDs that are off are left for the
+ * layers below to show through
+ */
+static inline void leds_blink_run(app_led_data_t *leds, uint16_t start, uint16_t end,
+				  rgb_color_t c)
+{
+	if (c.hex != 0 || !leds_composing(leds)) {
+		leds_batch_fill(leds, start, end, c, leds->global_brightness);
+	}
+}
+
+/* Render blink state; called from app_led_update with the frame batched
+ *
+ * LEDs blinking together are written as one span rather than pixel by pixel.
+ */
+static void app_led_update_blink_mode(app_led_data_t *leds, k_timeout_t block)
+{
+	int64_t now = k_uptime_get();
+	bool change_mode = true;
+	struct app_led_blink *led;
+	rgb_color_t *color;
+	uint16_t run_start = 0;
+	rgb_color_t run_color = {0};
+
+	for (uint16_t i = 0; IS_ENABLED(CONFIG_APP_LED_BLINK) && i < leds->num_leds; i++) {
+		led = &leds->blink[i];
+		color = leds_blink_color(leds, i);
+		// turn on if within on period, else off (off_period is just used to blank
+		// app_led_indicate_act)
+		if (now >= led->on_time_ms_left) {
+			*color = RGBHEX(Black);
+		}
+
+		if (i == 0) {
+			run_color = *color;
+		} else if (color->hex != run_color.hex) {
+			leds_blink_run(leds, run_start, i, run_color);
+			run_start = i;
+			run_color = *color;
+		}
 
-	if (k_uptime_get() - data->last_tick >= (step->time_in_10ms * 10) / leds->num_leds) {
-		if (data->count > leds->num_leds)
-			data->count = 0;
+		// don't exit mode until all leds have elapsed off period
+		if (led->off_time_ms_left >= now)
+			change_mode = false;
+	}
+	if (IS_ENABLED(CONFIG_APP_LED_BLINK) && leds->num_leds > 0) {
+		leds_blink_run(leds, run_start, leds->num_leds, run_color);
+	}
 
-		leds_set_pixel(leds, data->count++, data->color, leds->global_brightness, block);
-		data->last_tick = k_uptime_get();
+	// go back to last mode once off period elasped for all
+	if (change_mode) {
+		IF_ENABLED(CONFIG_APP_LED_LAYERS, (leds_layer_end(leds, APP_LED_LAYER_BLINK, block);))
+		// an error shown over the blink stays
+		if (leds->mode == Blink) {
+			app_led_last_mode(leds, block);
+		}
 	}
 }
 
-void app_led_fade_blink(void *const pleds, const void *const pstep, k_timeout_t block)
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+/* Render the base layer */
+static void leds_render_base(app_led_data_t *leds)
 {
-	app_led_data_t *leds = (app_led_data_t *)pleds;
-	app_led_sequence_step_t *step = (app_led_sequence_step_t *)pstep;
-	app_led_sequence_data_t *data = &leds->sequence_data;
-	data->color = leds->global_color;
-
-	app_led_fade_color(leds, 16, RGBHEX(Black), block);
-
-	if (k_uptime_get() - data->last_tick >= (step->time_in_10ms * 10) / 2) {
-		leds_set_pixels(leds, 0, leds->num_leds, data->color, leds->global_brightness,
-				block);
-		data->last_tick = k_uptime_get();
+	if (leds_base_mode(leds) == Rainbow) {
+		leds->hue++;
+		leds_set_pixels(leds, 0, leds->num_leds, app_led_hsv_to_rgb(leds->hue, 255, 255),
+				leds->global_brightness, K_FOREVER);
+	} else {
+		leds_set_pixels(leds, 0, leds->num_leds, leds->global_color,
+				leds->global_brightness, K_FOREVER);
 	}
 }
 
-void app_led_half_blink(void *const pleds, const void *const pstep, k_timeout_t block)
+/* Composite the active layers bottom to top then write the frame to the backend in one span;
+ * called from app_led_update with the frame batched
+ *
+ * Each layer only writes the pixels it covers, blended over the layers below by its alpha and
+ * blend mode. Layers that aren't active are skipped and an opaque base on its own is written
+ * straight to the backend.
+ */
+static void app_led_update_layers(app_led_data_t *leds)
 {
-	app_led_data_t *leds = (app_led_data_t *)pleds;
-	app_led_sequence_step_t *step = (app_led_sequence_step_t *)pstep;
-	app_led_sequence_data_t *data = &leds->sequence_data;
-	data->color = leds->global_color;
+	const struct app_led_layer_cfg *base = &leds->layers[APP_LED_LAYER_BASE];
 
-	if (data->count) {
-		app_led_fade_color(leds, 16, RGBHEX(Black), block);
-		leds_set_pixels(leds, 0, leds->num_leds / 2, data->color, leds->global_brightness,
-				block);
+	if (leds->mode == Off) {
+		leds_set_pixels(leds, 0, leds->num_leds, RGBHEX(Black), leds->global_brightness,
+				K_FOREVER);
+		return;
 	}
 
-	if (k_uptime_get() - data->last_tick >= (step->time_in_10ms * 10) / 2) {
-		leds_set_pixels(leds, 0, leds->num_leds, data->color, leds->global_brightness,
-				block);
-		if (data->count == 0) {
-			data->count = 1;
-		} else {
-			data->count = 0;
+	if (leds->layers_active == BIT(APP_LED_LAYER_BASE) && base->alpha == 0xFF &&
+	    base->blend == APP_LED_BLEND_NORMAL) {
+		leds_render_base(leds);
+		return;
+	}
+
+	memset(leds->layer_frame, 0, leds->num_leds * sizeof(rgb_color_t));
+	for (int layer = 0; layer < APP_LED_NUM_LAYERS; layer++) {
+		if ((leds->layers_active & BIT(layer)) == 0 || leds->layers[layer].alpha == 0) {
+			continue;
+		}
+
+		leds->layer = layer;
+		switch (layer) {
+		case APP_LED_LAYER_BASE:
+			leds_render_base(leds);
+			break;
+		case APP_LED_LAYER_SEQUENCE:
+			app_led_update_sequence(leds, K_FOREVER);
+			break;
+		case APP_LED_LAYER_BLINK:
+			app_led_update_blink_mode(leds, K_FOREVER);
+			break;
+		default:
+			leds_set_pixels(leds, 0, leds->num_leds, RGBHEX(Red),
+					leds->global_brightness, K_FOREVER);
+			break;
 		}
-		data->last_tick = k_uptime_get();
 	}
+	leds->layer = -1;
+
+	LEDS_FUNCS(leds)->write_span(leds, 0, leds->num_leds, leds->layer_frame,
+				     sizeof(rgb_color_t), 0xFF);
 }
+#endif
 
-void app_led_sine(void *const pleds, const void *const pstep, k_timeout_t block)
-{
-	app_led_data_t *leds = (app_led_data_t *)pleds;
-	app_led_sequence_data_t *data = &leds->sequence_data;
-	data->color = leds->global_color;
+#if IS_ENABLED(CONFIG_APP_LED_CMD_QUEUE)
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_APP_LED_CMD_QUEUE_SIZE),
+	     "CONFIG_APP_LED_CMD_QUEUE_SIZE must be a power of two");
 
-	app_led_fade_color(leds, 6, RGBHEX(Black), block);
+#define LEDS_CMD_MASK (CONFIG_APP_LED_CMD_QUEUE_SIZE - 1U)
 
-	if (k_uptime_get() - data->last_tick >= data->count * 10) {
-		if (data->count > leds->num_leds) {
-			data->count = 0;
-			leds->_toggle = !leds->_toggle;
-		}
+/* Ring positions wrap so compare as a signed distance */
+static inline int32_t leds_cmd_seq_diff(atomic_val_t seq, uint32_t pos)
+{
+	return (int32_t)((uint32_t)seq - pos);
+}
 
-		leds_set_pixel(leds, leds->_toggle ? (leds->num_leds - ++data->count) : data->count++,
-			       data->color, leds->global_brightness, block);
-		data->last_tick = k_uptime_get();
+/* Mark every slot free for the first lap; call before leds is initialized */
+static void leds_cmd_init(app_led_data_t *leds)
+{
+	for (uint32_t i = 0; i < CONFIG_APP_LED_CMD_QUEUE_SIZE; i++) {
+		atomic_set(&leds->cmd_ring[i].seq, (atomic_val_t)i);
 	}
+	atomic_set(&leds->cmd_tail, 0);
+	leds->cmd_head = 0;
 }
 
-static uint32_t app_led_show_sequence_step(app_led_data_t *leds, uint8_t step_num,
-					   k_timeout_t block)
+/* Bounded multi-producer, single consumer ring: producers claim a position by CAS on cmd_tail,
+ * copy the command in and publish it by advancing the slot seq. The update is the only consumer.
+ */
+int app_led_cmd_push(app_led_data_t *leds, const struct app_led_cmd *cmd)
 {
-	// exit if no sequence obtained
-	uint32_t ret = 0xFF * 10;
-
-	if (k_mutex_lock(&leds->mutex, block) == 0) {
-		if (leds->sequence != NULL) {
-			// get the sequence step
-			const app_led_sequence_step_t *step = &leds->sequence[step_num];
+	struct app_led_cmd_slot *slot;
+	uint32_t pos;
+	int32_t diff;
 
-			// clamp to current global brightness
-			leds->sequence_data.brightness =
-				step->start_brightness > leds->global_brightness &&
-						leds->global_brightness != 0
-					? leds->global_brightness
-					: step->start_brightness;
-			// set the sequence step colour
-			leds->sequence_data.color = step->color;
-
-			// calculate fade step if not stop frame or start != end since our
-			// starting brightness is clamped it might not equal start anymore
-			if (step->time_in_10ms != 0xFF &&
-			    (step->start_brightness != step->end_brightness)) {
-				if (step->time_in_10ms > 1) {
-					leds->sequence_data.fade_step =
-						ceil((double)abs(leds->sequence_data.brightness -
-								 step->end_brightness) /
-						     step->time_in_10ms);
-				} else {
-					leds->sequence_data.fade_step = 255;
-				}
-			} else {
-				leds->sequence_data.fade_step = 0;
-			}
+	if (!leds->initialized) {
+		return -ENODEV;
+	}
 
-			// set the sequence step colour
-			if (step->fnc != NULL) {
-				step->fnc(leds, step, block);
-			} else {
-				leds_set_pixels(leds, 0, leds->num_leds, leds->sequence_data.color,
-						leds->sequence_data.brightness, block);
+	pos = (uint32_t)atomic_get(&leds->cmd_tail);
+	for (;;) {
+		slot = &leds->cmd_ring[pos & LEDS_CMD_MASK];
+		diff = leds_cmd_seq_diff(atomic_get(&slot->seq), pos);
+		if (diff == 0) {
+			if (atomic_cas(&leds->cmd_tail, (atomic_val_t)pos,
+				       (atomic_val_t)(pos + 1))) {
+				break;
 			}
-			ret = 10 * step->time_in_10ms;
+		} else if (diff < 0) {
+			// slot from the last lap not applied yet so ring is full
+			atomic_inc(&leds->stats.cmds_dropped);
+			return -ENOMEM;
 		}
-
-		k_mutex_unlock(&leds->mutex);
+		// another producer claimed pos
+		pos = (uint32_t)atomic_get(&leds->cmd_tail);
 	}
 
-	return ret;
-}
-
-static void app_led_update_sequence(app_led_data_t *leds, k_timeout_t block)
-{
-	int64_t now = k_uptime_get();
+	slot->cmd = *cmd;
+	atomic_set(&slot->seq, (atomic_val_t)(pos + 1));
 
-	// if ready for next step in sequence
-	if (now > leds->time_sequence_next) {
-		// get time of next
-		uint32_t t = app_led_show_sequence_step(leds, leds->sequence_step, block);
-
-		// check if exit flag
-		if (t == 0xFF * 10) {
-			// check if repeat - not equal to zero allows -1 to run forever
-			if (leds->sequence_repeat_count != 0) {
-				if (k_mutex_lock(&leds->mutex, block) == 0) {
-					// decrement if > 0 so we exit after count
-					if (leds->sequence_repeat_count > 0) {
-						leds->sequence_repeat_count--;
-					}
-					// start again
-					leds->sequence_step = 0;
-					k_mutex_unlock(&leds->mutex);
-				}
-			} else {
-				// sequence over so go back to last mode and return
-				app_led_sequence_clear(leds, block);
-			}
-			// else set next timeout and increment for next step
-		} else {
-			if (k_mutex_lock(&leds->mutex, block) == 0) {
-				++leds->sequence_step; // do this not inline so step will not
-						       // overflow on last
-				leds->time_sequence_next = now + t;
-				k_mutex_unlock(&leds->mutex);
-			}
-		}
-	} else if (leds->sequence_step > 0) {
-		if (k_mutex_lock(&leds->mutex, block) == 0) {
-			// -1 because sequence_step is incremented for next call; it's the next
-			// step index
-			const app_led_sequence_step_t *step =
-				&leds->sequence[leds->sequence_step - 1];
-
-			// poll fnc
-			if (step->fnc != NULL) {
-				step->fnc(leds, step, block);
-			}
+	IF_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE, (leds_wake(leds);))
 
-			// adjust brightness for sequence - could modulate color based on sequence
-			// brightness and step
-			if (leds->sequence_data.brightness != step->end_brightness &&
-			    leds->sequence_data.fade_step != 0 && step->time_in_10ms != 0xFF) {
-				if ((leds->sequence_data.brightness -
-				     leds->sequence_data.fade_step) > step->end_brightness) {
-					leds->sequence_data.brightness -=
-						leds->sequence_data.fade_step;
-				} else if ((leds->sequence_data.brightness +
-					    leds->sequence_data.fade_step) < step->end_brightness) {
-					leds->sequence_data.brightness +=
-						leds->sequence_data.fade_step;
-				} else {
-					leds->sequence_data.brightness = step->end_brightness;
-				}
-				leds_set_pixels(leds, 0, leds->num_leds, leds->sequence_data.color,
-						leds->sequence_data.brightness, block);
-			}
+	return 0;
+}
 
-			k_mutex_unlock(&leds->mutex);
-		}
+static void leds_cmd_apply(app_led_data_t *leds, const struct app_led_cmd *cmd)
+{
+	switch (cmd->type) {
+	case APP_LED_CMD_SET_COLOR:
+		app_led_set_global_color(leds, cmd->set.color, K_FOREVER);
+		break;
+	case APP_LED_CMD_SET_INDEX:
+		app_led_set_index(leds, cmd->set.index, cmd->set.color, K_FOREVER);
+		break;
+	case APP_LED_CMD_BLINK:
+		app_led_blink(leds, cmd->blink.color, cmd->blink.on_ms, cmd->blink.off_ms,
+			      cmd->blink.state_override, K_FOREVER);
+		break;
+	case APP_LED_CMD_SEQUENCE:
+		app_led_run_sequence(leds, cmd->sequence.steps, cmd->sequence.num_repeat,
+				     K_FOREVER);
+		break;
+	case APP_LED_CMD_BRIGHTNESS:
+		app_led_set_global_brightness(leds, cmd->brightness, K_FOREVER);
+		break;
+	default:
+		LOG_WRN("Unknown command %d", cmd->type);
+		break;
 	}
 }
 
-static void app_led_update_blink_mode(app_led_data_t *leds, k_timeout_t block)
+/* Apply every published command in order; only called from leds_update with the frame locked, so
+ * there is a single consumer
+ */
+static void leds_cmd_drain(app_led_data_t *leds)
 {
-	int64_t now = k_uptime_get();
-	bool change_mode = true;
-	struct app_led_state *led;
+	struct app_led_cmd_slot *slot;
+	struct app_led_cmd cmd;
 
-	for (int i = 0; i < leds->num_leds; i++) {
-		led = &leds->state[i];
-		// turn on if within on period, else off (off_period is just used to blank
-		// app_led_indicate_act)
-		app_led_set_index(leds, i, now < led->on_time_ms_left ? led->color : RGBHEX(Black),
-				  block);
+	for (;;) {
+		slot = &leds->cmd_ring[leds->cmd_head & LEDS_CMD_MASK];
+		if (leds_cmd_seq_diff(atomic_get(&slot->seq), leds->cmd_head + 1) != 0) {
+			break;
+		}
 
-		// don't exit mode until all leds have elapsed off period
-		if (led->off_time_ms_left >= now)
-			change_mode = false;
-	}
+		// copy out and free the slot before applying so producers are not held
+		cmd = slot->cmd;
+		atomic_set(&slot->seq,
+			   (atomic_val_t)(leds->cmd_head + CONFIG_APP_LED_CMD_QUEUE_SIZE));
+		leds->cmd_head++;
 
-	// go back to last mode once off period elasped for all
-	if (change_mode)
-		app_led_last_mode(leds, block);
+		leds_cmd_apply(leds, &cmd);
+		leds->stats.cmds_processed++;
+	}
 }
+#endif
 
-/**
- * @brief Update App LED state machine
- *
- * This function is called from the LED task thread to update the LED state machine and set the
- * LEDs. If not using the LED task, this function can be called from a App thread to update the
- * LEDs at a regular interval.
- */
-void app_led_update(app_led_data_t *leds)
+/* Run the state machine for a frame; call from within the frame batch */
+static inline void leds_render(app_led_data_t *leds)
 {
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	app_led_update_layers(leds);
+#else
 	switch (leds->mode) {
 	case Manual:
 		// if manual mode, just set the colour - will be suspended if
@@ -1081,34 +2984,230 @@ void app_led_update(app_led_data_t *leds)
 				K_FOREVER);
 		break;
 	}
+#endif
+}
+
+/* Apply queued commands and, if render, run the state machine for a frame */
+static void leds_update(app_led_data_t *leds, bool render)
+{
+	uint32_t start = k_cycle_get_32();
+	uint32_t cycles;
+	bool nested;
+
+	// hold the lock for the whole frame; nested calls take it recursively
+	if (leds_batch_begin(leds, K_FOREVER, &nested) != 0) {
+		return;
+	}
+
+	IF_ENABLED(CONFIG_APP_LED_CMD_QUEUE, (leds_cmd_drain(leds);))
+
+	if (render) {
+		leds_render(leds);
+	}
+
+	// everything rendered above is committed in one pass
+	if (leds_batch_end(leds, nested) != 0) {
+		LOG_ERR("Couldn't commit %s", leds->app_led->name);
+	}
+
+	if (render) {
+		cycles = k_cycle_get_32() - start;
+		leds->stats.update_count++;
+		leds->stats.last_update_cycles = cycles;
+		leds->stats.max_update_cycles = MAX(leds->stats.max_update_cycles, cycles);
+	}
+
+	// blink or sequence ended in the frame
+	if (!nested && leds->done_pending != 0) {
+		leds_report_done(leds);
+	}
+}
+
+/**
+ * @brief Update App LED state machine
+ *
+ * This function is called from the LED task thread to update the LED state machine and set the
+ * LEDs. If not using the LED task, this function can be called from a App thread to update the
+ * LEDs at a regular interval.
+ */
+void app_led_update(app_led_data_t *leds)
+{
+	leds_update(leds, true);
 }
 
 #if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
+/* True if leds needs background updates in its current mode */
+static inline bool leds_is_active(const app_led_data_t *leds)
+{
+	return (leds->mode != Manual && leds->mode != Off) ||
+	       !IS_ENABLED(CONFIG_APP_LED_SUSPEND_TASK_MANUAL);
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_TICKLESS)
+/* Uptime the blink state next changes */
+static int64_t leds_blink_next_change(const app_led_data_t *leds, int64_t now)
+{
+	int64_t next = INT64_MAX;
+
+	for (int i = 0; IS_ENABLED(CONFIG_APP_LED_BLINK) && i < leds->num_leds; i++) {
+		const struct app_led_blink *led = &leds->blink[i];
+
+		// turns off at on_time_ms_left, mode exits once past off_time_ms_left
+		if (now < led->on_time_ms_left) {
+			next = MIN(next, (int64_t)led->on_time_ms_left);
+		} else if (now <= led->off_time_ms_left) {
+			next = MIN(next, (int64_t)led->off_time_ms_left + 1);
+		}
+	}
+
+	return next;
+}
+
+/* Uptime the sequence next changes, now if it changes every update */
+static int64_t leds_sequence_next_change(const app_led_data_t *leds, int64_t now)
+{
+	const app_led_sequence_step_t *step;
+
+	// a cached sequence doesn't load steps so also changes every update
+	if (leds->sequence_step == 0) {
+		return now;
+	}
+
+	step = leds_sequence_current(leds);
+	if ((step != NULL && step->fnc != NULL) || leds_sequence_fading(&leds->sequence_data)) {
+		return now;
+	}
+
+	// static step so next change is the next step
+	return leds->sequence_data.step_start + leds->sequence_data.step_ms;
+}
+
+/* Milliseconds from now until the output of leds next changes on its own
+ *
+ * Animated modes change every update so run at CONFIG_APP_LED_UPDATE_PERIOD. Blink and Sequence
+ * steps without a fade or step function only change at the next blink edge or step; with layers
+ * the soonest of the active layers is taken.
+ */
+static int32_t leds_next_change_ms(const app_led_data_t *leds, int64_t now)
+{
+	int64_t next = INT64_MAX;
+
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+	if (leds->mode != Off) {
+		if (leds_base_mode(leds) == Rainbow) {
+			next = now;
+		}
+		if (leds->layers_active & BIT(APP_LED_LAYER_SEQUENCE)) {
+			next = MIN(next, leds_sequence_next_change(leds, now));
+		}
+		if (leds->layers_active & BIT(APP_LED_LAYER_BLINK)) {
+			next = MIN(next, leds_blink_next_change(leds, now));
+		}
+	}
+#else
+	switch (leds->mode) {
+	case Blink:
+		next = leds_blink_next_change(leds, now);
+		break;
+	case Sequence:
+		next = leds_sequence_next_change(leds, now);
+		break;
+	default:
+		break;
+	}
+#endif
+
+	if (next == INT64_MAX) {
+		return CONFIG_APP_LED_UPDATE_PERIOD;
+	}
+
+	return (int32_t)MAX(next - now, CONFIG_APP_LED_UPDATE_PERIOD);
+}
+#else
+static inline int32_t leds_next_change_ms(const app_led_data_t *leds, int64_t now)
+{
+	return CONFIG_APP_LED_UPDATE_PERIOD;
+}
+#endif
+
+/* Run the state machine if active and due, then flush strip LEDs if using LED_STRIP driver
+ *
+ * Returns milliseconds from now until leds is next due an update, -1 if suspended.
+ */
+static int32_t app_led_work_update(app_led_data_t *leds, int64_t now)
+{
+	// woken by a state change or command, cleared first so a wake during the update isn't lost
+	if (atomic_clear(&leds->wake)) {
+		leds->next_change = now;
+	}
+
+	// commands are applied even if suspended in Manual/Off; one changing to an active mode wakes
+	// the work again to render it
+	if (leds_is_active(leds) && now >= leds->next_change) {
+		leds_update(leds, true);
+		leds->next_change = now + leds_next_change_ms(leds, now);
+	} else if (IS_ENABLED(CONFIG_APP_LED_CMD_QUEUE)) {
+		leds_update(leds, false);
+	}
+
+	// strip flush is skipped if nothing changed; needed even when suspended for manual changes
+	if (LEDS_FUNCS(leds)->flush != NULL) {
+		LEDS_FUNCS(leds)->flush(leds);
+	}
+
+	return leds_is_active(leds) ? (int32_t)MAX(0, leds->next_change - now) : -1;
+}
+
+#if IS_ENABLED(CONFIG_APP_LED_SHARED_WORK)
+/* Update every initialized App LED that is due in one wakeup, skipping suspended Manual/Off
+ * instances
+ */
+static void app_led_shared_work_handler(struct k_work *work)
+{
+	int64_t last_update_time = k_uptime_get();
+	int64_t now = last_update_time;
+	int32_t next = INT32_MAX;
+	int32_t due;
+
+	STRUCT_SECTION_FOREACH(app_led_data, leds) {
+		if (!leds->initialized) {
+			continue;
+		}
+
+		leds_record_late(leds, now);
+		due = app_led_work_update(leds, now);
+		if (due >= 0) {
+			next = MIN(next, due);
+		}
+	}
+
+	/* Reschedule the work for the soonest instance not in Manual or Off mode */
+	if (next != INT32_MAX) {
+		// Calculate next deadline based on execution time
+		int32_t delay = MAX(0, next - k_uptime_delta(&last_update_time));
+		leds_reschedule(NULL, last_update_time, delay);
+	}
+}
+#else
 static void app_led_work_handler(struct k_work *work)
 {
 	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
 	app_led_data_t *leds = CONTAINER_OF(dwork, app_led_data_t, dwork);
 	int64_t last_update_time = k_uptime_get();
+	int32_t next;
 
-	app_led_update(leds);
-
-	/* Update strip LEDs here if using LED_STRIP driver */
-#if IS_ENABLED(CONFIG_LED_STRIP)
-	if (leds->hw_type == APP_LED_TYPE_STRIP) {
-		leds_strip_update(leds);
-	}
-#endif
+	leds_record_late(leds, last_update_time);
+	next = app_led_work_update(leds, last_update_time);
 
 	/* Reschedule the work if not in Manual or Off mode */
-	if ((leds->mode != Manual && leds->mode != Off) ||
-	    !IS_ENABLED(CONFIG_APP_LED_SUSPEND_TASK_MANUAL)) {
-		// Calculate next deadline based on period and execution time
-		k_timeout_t delay = K_MSEC(
-			MAX(0, CONFIG_APP_LED_UPDATE_PERIOD - k_uptime_delta(&last_update_time)));
-		k_work_reschedule(&leds->dwork, delay);
+	if (next >= 0) {
+		// Calculate next deadline based on execution time
+		int32_t delay = MAX(0, next - k_uptime_delta(&last_update_time));
+		leds_reschedule(leds, last_update_time, delay);
 	}
 }
 #endif
+#endif
 
 /**
  * @brief Initialize the App LED module
@@ -1118,6 +3217,8 @@ static void app_led_work_handler(struct k_work *work)
  */
 int app_led_init(app_led_data_t *leds)
 {
+	int err;
+
 #if !(IS_ENABLED(CONFIG_GPIO_EMUL) && IS_ENABLED(CONFIG_TEST))
 	if (!device_is_ready(leds->app_led)) {
 		LOG_ERR("Device %s is not ready", leds->app_led->name);
@@ -1125,10 +3226,42 @@ int app_led_init(app_led_data_t *leds)
 	}
 #endif
 
+#if IS_ENABLED(CONFIG_APP_LED_BRIGHTNESS_LUT)
+	if (k_mutex_lock(&leds->mutex, K_FOREVER) == 0) {
+		leds_build_scale_lut(leds, leds->global_brightness);
+		k_mutex_unlock(&leds->mutex);
+	}
+#endif
+
+	IF_ENABLED(CONFIG_APP_LED_CMD_QUEUE, (leds_cmd_init(leds);))
+
+	__ASSERT(leds->funcs == LEDS_FUNCS(leds),
+		 "%s funcs ignored in single backend build, enable CONFIG_APP_LED_CUSTOM_BACKEND",
+		 leds->app_led->name);
+
+	if (LEDS_FUNCS(leds)->init != NULL) {
+		err = LEDS_FUNCS(leds)->init(leds);
+		if (err != 0) {
+			LOG_ERR("Couldn't init %s backend: %d", leds->app_led->name, err);
+			return err;
+		}
+	}
+
+	if (leds->hw_shadow != NULL) {
+		// driver state at boot is not known so the first commit writes every channel
+		for (int i = 0; i < leds->hw_num_leds; i++) {
+			leds->hw_shadow[i] = LEDS_HW_UNKNOWN;
+		}
+	}
+
+	leds->initialized = true;
+
 #if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
 	/* Init delayed work and call first time to schedule the work */
+#if !IS_ENABLED(CONFIG_APP_LED_SHARED_WORK)
 	k_work_init_delayable(&leds->dwork, app_led_work_handler);
-	k_work_schedule(&leds->dwork, K_NO_WAIT);
+#endif
+	leds_schedule(leds);
 #endif
 
 	LOG_INF("App LED %s initialized", leds->app_led->name);
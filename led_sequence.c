@@ -76,7 +76,7 @@ app_led_sequence_step_t app_led_charging_sequence[] = {
 // Sequence to do boot fade
 // both fade and breathe call the same function, to update the color based on
 // current global value
-app_led_sequence_step_t app_led_fade_sequence[] = {
+const app_led_sequence_step_t app_led_fade_sequence[] = {
 	{.fnc = &app_led_seq_fnc,
 	 .color = RGBHEX(Black),
 	 .time_in_10ms = 150,
@@ -194,7 +194,7 @@ const app_led_sequence_step_t *app_led_sequences[] = {
 };
 
 // table of sequence lengths
-const uint8_t app_led_sequence_lengths[] = {
+const uint16_t app_led_sequence_lengths[] = {
 	ARRAY_SIZE(app_led_test_sequence),	 ARRAY_SIZE(app_led_error_sequence),
 	ARRAY_SIZE(app_led_blank_sequence),	 ARRAY_SIZE(app_led_charging_sequence),
 	ARRAY_SIZE(app_led_fade_sequence),	 ARRAY_SIZE(app_led_fade_sequence),
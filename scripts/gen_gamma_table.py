@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Generate the App LED gamma correction table as a const C array.
+
+Called from CMakeLists.txt when CONFIG_APP_LED_GAMMA=y with the exponent from
+CONFIG_APP_LED_GAMMA_EXPONENT (in tenths, so 22 is gamma 2.2).
+"""
+
+import argparse
+
+
+def gamma_table(exponent):
+    return [round(255 * ((i / 255) ** exponent)) for i in range(256)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--exponent", type=int, required=True,
+                        help="gamma exponent in tenths, e.g. 22 for 2.2")
+    parser.add_argument("--output", required=True, help="C file to write")
+    args = parser.parse_args()
+
+    table = gamma_table(args.exponent / 10)
+    rows = [", ".join(f"{v:3d}" for v in table[i:i + 16]) for i in range(0, 256, 16)]
+
+    with open(args.output, "w") as f:
+        f.write("/* Generated by scripts/gen_gamma_table.py - do not edit */\n")
+        f.write("#include <stdint.h>\n\n")
+        f.write(f"/* gamma {args.exponent / 10:.1f} */\n")
+        f.write("const uint8_t app_led_gamma_table[256] = {\n")
+        for row in rows:
+            f.write(f"\t{row},\n")
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,180 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <app_led/led.h>
+
+#define NUM_PRODUCERS	   3
+#define PUSHES_PER_THREAD  200
+#define PUSHES_FROM_ISR	   50
+#define PRODUCER_STACK	   1024
+#define PRODUCER_PRIORITY  K_PRIO_PREEMPT(5)
+#define STRESS_TIMEOUT_MS  10000
+
+APP_LED_STATIC_DEFINE(cmd_led_inst, DT_ALIAS(cmd_gpio_leds), 1, 0);
+APP_LED_STATIC_DEFINE(uninit_led_inst, DT_ALIAS(cmd_gpio_leds), 1, 0); // never initialized
+
+K_THREAD_STACK_ARRAY_DEFINE(producer_stacks, NUM_PRODUCERS, PRODUCER_STACK);
+static struct k_thread producer_threads[NUM_PRODUCERS];
+
+static atomic_t pushed;
+static atomic_t rejected;
+static atomic_t errors;
+static atomic_t isr_pushed;
+static uint32_t push_cycles_max;
+static uint64_t push_cycles_total;
+
+/* Push with timing; returns push result. Called from the ISR producer so no asserts */
+static int timed_push(const struct app_led_cmd *cmd)
+{
+	uint32_t start = k_cycle_get_32();
+	int ret = app_led_cmd_push(&cmd_led_inst, cmd);
+	uint32_t cycles = k_cycle_get_32() - start;
+	unsigned int key = irq_lock();
+
+	push_cycles_total += cycles;
+	push_cycles_max = MAX(push_cycles_max, cycles);
+	irq_unlock(key);
+
+	if (ret == 0) {
+		atomic_inc(&pushed);
+	} else if (ret == -ENOMEM) {
+		atomic_inc(&rejected);
+	} else {
+		atomic_inc(&errors);
+	}
+
+	return ret;
+}
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	struct app_led_cmd cmd = {.type = APP_LED_CMD_BRIGHTNESS};
+
+	for (int i = 0; i < PUSHES_PER_THREAD; i++) {
+		cmd.brightness = (uint8_t)i;
+		// ring full, wait for the consumer and retry so every command lands
+		while (timed_push(&cmd) == -ENOMEM) {
+			k_sleep(K_TICKS(1));
+		}
+		if ((i % 16) == 0) {
+			k_sleep(K_TICKS(1));
+		}
+	}
+}
+
+static void isr_producer(struct k_timer *timer)
+{
+	struct app_led_cmd cmd = {.type = APP_LED_CMD_SET_COLOR, .set.color = RGBHEX(White)};
+
+	if (atomic_get(&isr_pushed) >= PUSHES_FROM_ISR) {
+		k_timer_stop(timer);
+		return;
+	}
+
+	if (timed_push(&cmd) == 0) {
+		atomic_inc(&isr_pushed);
+	}
+}
+
+static K_TIMER_DEFINE(isr_producer_timer, isr_producer, NULL);
+
+/* All commands pushed and every accepted one applied */
+static bool stress_done(uint32_t total, uint32_t processed)
+{
+	uint32_t accepted = atomic_get(&pushed);
+
+	return accepted == total && cmd_led_inst.stats.cmds_processed - processed == accepted;
+}
+
+static void *app_led_cmd_queue_setup(void)
+{
+	zassert_ok(app_led_init(&cmd_led_inst), "Init failed");
+
+	return NULL;
+}
+
+ZTEST_SUITE(app_led_cmd_queue, NULL, app_led_cmd_queue_setup, NULL, NULL, NULL);
+
+ZTEST(app_led_cmd_queue, test_push_before_init_rejected)
+{
+	zassert_equal(app_led_post_brightness(&uninit_led_inst, 10), -ENODEV);
+}
+
+ZTEST(app_led_cmd_queue, test_commands_applied_in_order)
+{
+	zassert_ok(app_led_post_color(&cmd_led_inst, RGBHEX(Red)));
+	zassert_ok(app_led_post_brightness(&cmd_led_inst, 10));
+	zassert_ok(app_led_post_brightness(&cmd_led_inst, 20));
+
+	app_led_update(&cmd_led_inst);
+
+	zassert_equal(cmd_led_inst.global_color.hex, RGBHEX(Red).hex);
+	zassert_equal(cmd_led_inst.global_brightness, 20, "last queued brightness should win");
+}
+
+ZTEST(app_led_cmd_queue, test_full_queue_rejects)
+{
+	uint32_t dropped = atomic_get(&cmd_led_inst.stats.cmds_dropped);
+
+	for (int i = 0; i < CONFIG_APP_LED_CMD_QUEUE_SIZE; i++) {
+		zassert_ok(app_led_post_brightness(&cmd_led_inst, i));
+	}
+	zassert_equal(app_led_post_brightness(&cmd_led_inst, 0xFF), -ENOMEM);
+	zassert_equal(atomic_get(&cmd_led_inst.stats.cmds_dropped), dropped + 1);
+
+	app_led_update(&cmd_led_inst);
+	zassert_equal(cmd_led_inst.global_brightness, CONFIG_APP_LED_CMD_QUEUE_SIZE - 1);
+	zassert_ok(app_led_post_brightness(&cmd_led_inst, 0xFF), "drain should free the ring");
+	app_led_update(&cmd_led_inst);
+}
+
+ZTEST(app_led_cmd_queue, test_stress_no_lost_commands)
+{
+	const uint32_t total = NUM_PRODUCERS * PUSHES_PER_THREAD + PUSHES_FROM_ISR;
+	uint32_t processed = cmd_led_inst.stats.cmds_processed;
+	uint32_t dropped = atomic_get(&cmd_led_inst.stats.cmds_dropped);
+	int64_t start = k_uptime_get();
+	uint32_t calls;
+
+	atomic_clear(&pushed);
+	atomic_clear(&rejected);
+	atomic_clear(&errors);
+	atomic_clear(&isr_pushed);
+	push_cycles_max = 0;
+	push_cycles_total = 0;
+
+	for (int i = 0; i < NUM_PRODUCERS; i++) {
+		k_thread_create(&producer_threads[i], producer_stacks[i], PRODUCER_STACK, producer,
+				NULL, NULL, NULL, PRODUCER_PRIORITY, 0, K_NO_WAIT);
+	}
+	k_timer_start(&isr_producer_timer, K_MSEC(1), K_MSEC(1));
+
+	// consumer: the update drains the ring as the workqueue would
+	while (!stress_done(total, processed)) {
+		zassert_true(k_uptime_get() - start < STRESS_TIMEOUT_MS, "stress test timed out");
+		app_led_update(&cmd_led_inst);
+		k_sleep(K_MSEC(1));
+	}
+
+	for (int i = 0; i < NUM_PRODUCERS; i++) {
+		zassert_ok(k_thread_join(&producer_threads[i], K_SECONDS(1)));
+	}
+	k_timer_stop(&isr_producer_timer);
+	app_led_update(&cmd_led_inst);
+
+	zassert_equal(atomic_get(&errors), 0, "push failed other than full");
+	zassert_equal(atomic_get(&pushed), total);
+	zassert_equal(cmd_led_inst.stats.cmds_processed - processed, total,
+		      "every accepted command should be applied exactly once");
+	zassert_equal(atomic_get(&cmd_led_inst.stats.cmds_dropped) - dropped,
+		      atomic_get(&rejected), "dropped stat should match rejected pushes");
+
+	calls = atomic_get(&pushed) + atomic_get(&rejected);
+	TC_PRINT("%u pushes (%ld rejected while full): avg %llu cycles, max %u cycles (%llu ns)\n",
+		 calls, atomic_get(&rejected), push_cycles_total / calls, push_cycles_max,
+		 k_cyc_to_ns_floor64(push_cycles_max));
+}
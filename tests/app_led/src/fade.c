@@ -0,0 +1,95 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <app_led/led.h>
+
+#include "test_util.h"
+
+#define NUM_FADES    16
+#define FADE_MS	     100
+#define FADE_STAGGER 10
+
+#define FADE_LED_DEFINE(i, _)                                                                      \
+	APP_LED_STATIC_OFFSET_DEFINE(fade_led_##i, DT_ALIAS(fade_gpio_leds), i, 1, 0)
+#define FADE_LED(i, _)	      &fade_led_##i
+
+LISTIFY(NUM_FADES, FADE_LED_DEFINE, (;));
+
+static app_led_data_t *const fade_leds[] = {LISTIFY(NUM_FADES, FADE_LED, (,))};
+
+/* Colour, brightness and length of each instance's fade are all different */
+static rgb_color_t fade_target(int i)
+{
+	return RGB(i * 16, 0xFF - i * 16, i);
+}
+
+static uint8_t fade_brightness(int i)
+{
+	return 0xFF - i;
+}
+
+static uint32_t fade_time(int i)
+{
+	return FADE_MS + i * FADE_STAGGER;
+}
+
+static void *app_led_fade_setup(void)
+{
+	for (int i = 0; i < NUM_FADES; i++) {
+		zassert_ok(app_led_init(fade_leds[i]), "Init failed");
+	}
+
+	return NULL;
+}
+
+static void app_led_fade_before(void *f)
+{
+	for (int i = 0; i < NUM_FADES; i++) {
+		app_led_set_mode(fade_leds[i], Manual, K_NO_WAIT);
+		app_led_set_global_color(fade_leds[i], RGBHEX(Black), K_NO_WAIT);
+		app_led_set_global_brightness(fade_leds[i], 0xFF, K_NO_WAIT);
+	}
+}
+
+ZTEST_SUITE(app_led_fade, NULL, app_led_fade_setup, app_led_fade_before, NULL, NULL);
+
+ZTEST(app_led_fade, test_concurrent_fades_independent)
+{
+	app_led_sequence_data_t *data;
+	uint32_t shown[NUM_FADES];
+	rgb_color_t c;
+
+	for (int i = 0; i < NUM_FADES; i++) {
+		zassert_ok(app_led_fade_to(fade_leds[i], fade_target(i), fade_brightness(i),
+					   fade_time(i), K_NO_WAIT));
+	}
+
+	// every fade still heads for its own colour after the others started
+	k_sleep(K_MSEC(FADE_MS / 2));
+	for (int i = 0; i < NUM_FADES; i++) {
+		data = &fade_leds[i]->sequence_data;
+		shown[i] = test_shown(fade_leds[i]);
+		c.hex = shown[i];
+		zassert_equal(fade_leds[i]->mode, Sequence, "Fade %d ended early", i);
+		zassert_equal(data->to.hex, fade_target(i).hex, "Fade %d target overwritten", i);
+		zassert_equal(data->to_brightness, fade_brightness(i), "Fade %d brightness", i);
+		zassert_true(c.g > 0 && c.g < fade_target(i).g, "Fade %d not part way", i);
+
+		// updating this fade left the output of the ones before it alone
+		for (int j = 0; j < i; j++) {
+			zassert_ok(app_led_get_pixel_rgb(fade_leds[j], 0, &c));
+			zassert_equal(c.hex, shown[j], "Fade %d changed fade %d", i, j);
+		}
+	}
+
+	k_sleep(K_MSEC(fade_time(NUM_FADES - 1)));
+	for (int i = 0; i < NUM_FADES; i++) {
+		c = app_led_scale_color(fade_leds[i], fade_target(i), fade_brightness(i));
+		zassert_equal(test_shown(fade_leds[i]), c.hex, "Fade %d shows the wrong colour", i);
+		zassert_equal(fade_leds[i]->mode, Manual, "Fade %d did not end", i);
+		zassert_equal(fade_leds[i]->global_color.hex, fade_target(i).hex);
+	}
+}
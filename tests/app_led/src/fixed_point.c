@@ -0,0 +1,66 @@
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <app_led/led.h>
+
+/* Check the integer color helpers used in the per-frame path against the floating point
+ * calculations they replaced
+ */
+ZTEST_SUITE(app_led_fixed_point, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(app_led_fixed_point, test_scale8_matches_divide)
+{
+	for (int x = 0; x < 256; x++) {
+		for (int b = 0; b < 256; b++) {
+			zassert_equal(app_led_scale8(x, b), x * b / 255, "scale8(%d, %d)", x, b);
+		}
+	}
+}
+
+ZTEST(app_led_fixed_point, test_grayscale_within_1lsb)
+{
+	for (int r = 0; r < 256; r += 3) {
+		for (int g = 0; g < 256; g += 3) {
+			for (int b = 0; b < 256; b += 3) {
+				uint8_t ref = (uint8_t)(0.299 * r + 0.587 * g + 0.114 * b);
+				uint8_t fx = app_led_grayscale(RGB(r, g, b));
+
+				zassert_true(abs(ref - fx) <= 1, "grayscale(%d, %d, %d) %u != %u", r,
+					     g, b, fx, ref);
+			}
+		}
+	}
+}
+
+ZTEST(app_led_fixed_point, test_fade_step_matches_ceil)
+{
+	for (int from = 0; from < 256; from++) {
+		for (int to = 0; to < 256; to += 5) {
+			for (int steps = 2; steps < 0xFF; steps++) {
+				uint8_t ref = ceil((double)abs(from - to) / steps);
+
+				zassert_equal(app_led_fade_step(from, to, steps), ref,
+					      "fade_step(%d, %d, %d)", from, to, steps);
+			}
+		}
+	}
+}
+
+ZTEST(app_led_fixed_point, test_lerp8_matches_round)
+{
+	for (int a = 0; a < 256; a += 3) {
+		for (int b = 0; b < 256; b += 5) {
+			zassert_equal(app_led_lerp8(a, b, 0), a);
+			zassert_equal(app_led_lerp8(a, b, APP_LED_FRAC_ONE), b);
+			for (uint32_t frac = 0; frac <= APP_LED_FRAC_ONE; frac += 4099) {
+				uint8_t ref = lround(a + (b - a) * ((double)frac / APP_LED_FRAC_ONE));
+
+				zassert_true(abs(app_led_lerp8(a, b, frac) - ref) <= 1,
+					     "lerp8(%d, %d, %u)", a, b, frac);
+			}
+		}
+	}
+}
@@ -0,0 +1,101 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <stdlib.h>
+
+#include <app_led/led.h>
+
+#define BCM_PIN		5
+#define BCM_LEVELS	(BIT(CONFIG_APP_LED_GPIO_BCM_BITS) - 1)
+#define SAMPLE_TICKS	4000
+// timer slots are rounded up to whole ticks so allow a few percent
+#define DUTY_TOLERANCE	5
+
+// only built into the gpio_bcm scenario, fields below need CONFIG_APP_LED_GPIO_BCM
+#if IS_ENABLED(CONFIG_APP_LED_GPIO_BCM)
+APP_LED_STATIC_DEFINE(bcm_led_inst, DT_ALIAS(bcm_gpio_leds), 1, 0);
+
+static const struct device *const gpio_emul_dev = DEVICE_DT_GET(DT_ALIAS(gpio_emulator));
+
+/* Sample the pin every tick and return the percentage of samples it was on */
+static int measure_duty(void)
+{
+	int on = 0;
+
+	for (int i = 0; i < SAMPLE_TICKS; i++) {
+		k_sleep(K_TICKS(1));
+		on += gpio_emul_output_get(gpio_emul_dev, BCM_PIN);
+	}
+
+	return on * 100 / SAMPLE_TICKS;
+}
+
+static void *app_led_gpio_bcm_setup(void)
+{
+	zassert_ok(app_led_init(&bcm_led_inst), "Init failed");
+
+	return NULL;
+}
+
+static void app_led_gpio_bcm_after(void *f)
+{
+	app_led_set_global_color(&bcm_led_inst, RGBHEX(Black), K_NO_WAIT);
+}
+
+ZTEST_SUITE(app_led_gpio_bcm, NULL, app_led_gpio_bcm_setup, NULL, app_led_gpio_bcm_after, NULL);
+
+ZTEST(app_led_gpio_bcm, test_static_levels_stop_timer)
+{
+	zassert_ok(app_led_set_global_color(&bcm_led_inst, RGBHEX(White), K_NO_WAIT));
+	zassert_false(bcm_led_inst.bcm_running, "Timer running for full on");
+	zassert_equal(gpio_emul_output_get(gpio_emul_dev, BCM_PIN), 1);
+
+	zassert_ok(app_led_set_global_color(&bcm_led_inst, RGBHEX(Black), K_NO_WAIT));
+	zassert_false(bcm_led_inst.bcm_running, "Timer running for off");
+	zassert_equal(gpio_emul_output_get(gpio_emul_dev, BCM_PIN), 0);
+}
+
+ZTEST(app_led_gpio_bcm, test_duty_cycle_and_cost)
+{
+	const uint8_t values[] = {0x20, 0x80, 0xC0};
+	uint32_t start_cycles;
+	uint32_t elapsed_cycles;
+	uint64_t isr_cycles;
+	uint32_t isr_count;
+	uint8_t level;
+	int expected;
+	int duty;
+
+	ARRAY_FOR_EACH(values, i) {
+		zassert_ok(app_led_set_global_color(
+			&bcm_led_inst, RGB(values[i], values[i], values[i]), K_NO_WAIT));
+		zassert_true(bcm_led_inst.bcm_running, "Timer not started for part brightness");
+
+		level = bcm_led_inst.hw_shadow[0];
+		expected = level * 100 / BCM_LEVELS;
+		isr_count = bcm_led_inst.stats.bcm_isr_count;
+		isr_cycles = bcm_led_inst.stats.bcm_isr_cycles;
+		start_cycles = k_cycle_get_32();
+
+		duty = measure_duty();
+
+		elapsed_cycles = k_cycle_get_32() - start_cycles;
+		isr_count = bcm_led_inst.stats.bcm_isr_count - isr_count;
+		isr_cycles = bcm_led_inst.stats.bcm_isr_cycles - isr_cycles;
+		zassert_true(isr_count > 0, "Bit planes not stepped");
+
+		TC_PRINT("value 0x%02x level %u/%lu: duty %d%% (expected %d%%), %u ISRs avg %llu "
+			 "cycles max %u, %llu.%02llu%% CPU\n",
+			 values[i], level, BCM_LEVELS, duty, expected, isr_count,
+			 isr_cycles / isr_count, bcm_led_inst.stats.bcm_isr_max_cycles,
+			 isr_cycles * 100 / elapsed_cycles,
+			 isr_cycles * 10000 / elapsed_cycles % 100);
+
+		zassert_true(abs(duty - expected) <= DUTY_TOLERANCE, "duty %d%% expected %d%%",
+			     duty, expected);
+	}
+}
+#endif
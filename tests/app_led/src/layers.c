@@ -0,0 +1,131 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <app_led/led.h>
+
+#include "test_util.h"
+
+#define BLINK_MS 50
+#define FLASH_MS 20
+
+// only built into the layers scenario
+#if IS_ENABLED(CONFIG_APP_LED_LAYERS)
+APP_LED_STATIC_DEFINE(layered_led, DT_ALIAS(layers_gpio_leds), 3, 1);
+
+/* Held blue, repeating until cleared */
+static const app_led_keyframe_t hold_blue[] = {
+	{.color = RGBHEX(Blue), .brightness = 0xFF, .duration_ms = APP_LED_KEYFRAME_END},
+};
+
+/* Red for FLASH_MS, then ends */
+static const app_led_keyframe_t flash_red[] = {
+	{.color = RGBHEX(Red), .brightness = 0xFF, .duration_ms = FLASH_MS},
+	{.color = RGBHEX(Red), .brightness = 0xFF, .duration_ms = APP_LED_KEYFRAME_END},
+};
+
+static uint32_t done_flags;
+
+static void layers_done_cb(struct app_led_data *leds, uint32_t done, void *user_data)
+{
+	done_flags |= done;
+}
+
+static void *app_led_layers_setup(void)
+{
+	zassert_ok(app_led_init(&layered_led), "Init failed");
+
+	return NULL;
+}
+
+static void app_led_layers_before(void *f)
+{
+	app_led_set_done_callback(&layered_led, layers_done_cb, NULL);
+	app_led_sequence_clear(&layered_led, K_NO_WAIT);
+	app_led_blink_sync(&layered_led, RGBHEX(Black), K_NO_WAIT);
+	app_led_set_mode(&layered_led, Manual, K_NO_WAIT);
+	app_led_set_global_color(&layered_led, RGBHEX(Black), K_NO_WAIT);
+	for (int layer = 0; layer < APP_LED_NUM_LAYERS; layer++) {
+		app_led_layer_set(&layered_led, layer, 0xFF, APP_LED_BLEND_NORMAL, K_NO_WAIT);
+	}
+	done_flags = 0;
+}
+
+ZTEST_SUITE(app_led_layers, NULL, app_led_layers_setup, app_led_layers_before, NULL, NULL);
+
+ZTEST(app_led_layers, test_blink_over_sequence)
+{
+	app_led_run_keyframes(&layered_led, hold_blue, -1, K_NO_WAIT);
+	zassert_equal(test_shown(&layered_led), RGBHEX(Blue).hex);
+
+	// blink is not refused and the sequence carries on under it
+	zassert_ok(app_led_blink(&layered_led, RGBHEX(Red), BLINK_MS, BLINK_MS, false, K_NO_WAIT));
+	zassert_equal(layered_led.mode, Blink);
+	zassert_equal(test_shown(&layered_led), RGBHEX(Red).hex, "Blink not shown over sequence");
+
+	k_sleep(K_MSEC(BLINK_MS + 10));
+	zassert_equal(test_shown(&layered_led), RGBHEX(Blue).hex,
+		      "Sequence not shown in blink off period");
+
+	k_sleep(K_MSEC(BLINK_MS));
+	zassert_equal(test_shown(&layered_led), RGBHEX(Blue).hex);
+	zassert_equal(layered_led.mode, Sequence, "Not back to sequence after blink");
+	zassert_equal(done_flags, APP_LED_DONE_BLINK, "Sequence reported done");
+}
+
+ZTEST(app_led_layers, test_blink_over_effect)
+{
+	// the chase renders into the state colours every frame, blink colours are kept apart
+	app_led_run_sequence(&layered_led, app_led_chase_sequence, -1, K_NO_WAIT);
+	zassert_ok(app_led_blink(&layered_led, RGBHEX(Red), BLINK_MS, BLINK_MS, false, K_NO_WAIT));
+	test_shown(&layered_led);
+	zassert_equal(test_shown(&layered_led), RGBHEX(Red).hex, "Effect changed the blink colour");
+}
+
+ZTEST(app_led_layers, test_error_alpha_and_blend)
+{
+	zassert_ok(app_led_set_global_color(&layered_led, RGBHEX(Blue), K_NO_WAIT));
+	zassert_ok(app_led_layer_set(&layered_led, APP_LED_LAYER_ERROR, 0xFF, APP_LED_BLEND_ADD,
+				     K_NO_WAIT));
+	app_led_set_mode(&layered_led, Error, K_NO_WAIT);
+	zassert_equal(test_shown(&layered_led), RGBHEX(Magenta).hex, "Error not added over base");
+
+	zassert_ok(app_led_layer_set(&layered_led, APP_LED_LAYER_ERROR, 0x80, APP_LED_BLEND_NORMAL,
+				     K_NO_WAIT));
+	zassert_equal(test_shown(&layered_led), RGB(0x80, 0, 0x7F).hex, "Error not mixed by alpha");
+
+	zassert_equal(app_led_layer_set(&layered_led, APP_LED_NUM_LAYERS, 0xFF,
+					APP_LED_BLEND_NORMAL, K_NO_WAIT),
+		      -EINVAL);
+}
+
+ZTEST(app_led_layers, test_error_cleared_to_layer_below)
+{
+	app_led_run_keyframes(&layered_led, hold_blue, -1, K_NO_WAIT);
+	app_led_set_mode(&layered_led, Error, K_NO_WAIT);
+	zassert_equal(test_shown(&layered_led), RGBHEX(Red).hex);
+
+	app_led_last_mode(&layered_led, K_NO_WAIT);
+	zassert_equal(layered_led.mode, Sequence, "Sequence under error lost");
+	zassert_equal(test_shown(&layered_led), RGBHEX(Blue).hex);
+	zassert_equal(done_flags, 0);
+}
+
+ZTEST(app_led_layers, test_sequence_end_not_drawn_in_layer)
+{
+	zassert_ok(app_led_set_global_color(&layered_led, RGBHEX(Green), K_NO_WAIT));
+	zassert_ok(app_led_layer_set(&layered_led, APP_LED_LAYER_SEQUENCE, 0xFF, APP_LED_BLEND_ADD,
+				     K_NO_WAIT));
+	app_led_run_keyframes(&layered_led, flash_red, 0, K_NO_WAIT);
+	zassert_equal(test_shown(&layered_led), RGB(0xFF, 0x80, 0).hex);
+
+	// the mode restore as the sequence ends must not add the base colour in its layer again
+	k_sleep(K_MSEC(FLASH_MS * 2));
+	zassert_not_equal(test_shown(&layered_led), RGB(0xFF, 0xFF, 0).hex,
+			  "Global colour drawn into the sequence layer");
+	zassert_equal(layered_led.mode, Manual, "Sequence not ended");
+	zassert_equal(test_shown(&layered_led), RGBHEX(Green).hex);
+}
+#endif
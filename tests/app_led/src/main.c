@@ -81,8 +81,8 @@ static void app_led_gpio_before(void *f)
 	app_led_set_global_brightness(fixture->gpio, 0xFF, K_NO_WAIT);	   // Full brightness
 	app_led_sequence_clear(fixture->gpio, K_NO_WAIT);
 	// Reset blink state if needed (e.g., zero out timers in state array)
-	fixture->gpio->state[0].on_time_ms_left = 0;
-	fixture->gpio->state[0].off_time_ms_left = 0;
+	fixture->gpio->blink[0].on_time_ms_left = 0;
+	fixture->gpio->blink[0].off_time_ms_left = 0;
 
 	app_led_set_mode(fixture->rgb_gpio, Manual, K_NO_WAIT);
 	app_led_set_global_color(fixture->rgb_gpio, RGBHEX(Black), K_NO_WAIT); // Off
@@ -90,7 +90,7 @@ static void app_led_gpio_before(void *f)
 	app_led_sequence_clear(fixture->rgb_gpio, K_NO_WAIT);
 	// Reset blink state if needed...
 
-#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE)
+#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE) && !IS_ENABLED(CONFIG_APP_LED_SHARED_WORK)
 	// Ensure work items are cancelled before each test
 	(void)k_work_cancel_delayable(&fixture->gpio->dwork);
 	(void)k_work_cancel_delayable(&fixture->rgb_gpio->dwork);
@@ -118,7 +118,14 @@ static void run_update(app_led_data_t *leds)
 }
 
 // --- Test Suite Definition ---
-ZTEST_SUITE(app_led_gpio, NULL, app_led_gpio_setup, app_led_gpio_before, NULL, app_led_teardown);
+// pin checks assume on/off GPIO output; software dimming is covered by the gpio_bcm suite
+static bool app_led_gpio_on_off(const void *global_state)
+{
+	return !IS_ENABLED(CONFIG_APP_LED_GPIO_BCM);
+}
+
+ZTEST_SUITE(app_led_gpio, app_led_gpio_on_off, app_led_gpio_setup, app_led_gpio_before, NULL,
+	    app_led_teardown);
 
 ZTEST_F(app_led_gpio, test_gpio_led_brightness)
 {
@@ -128,3 +135,182 @@ ZTEST_F(app_led_gpio, test_gpio_led_brightness)
 	zassert_equal(fixture->gpio->global_brightness, 50, "Brightness not set correctly");
 	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 0), 1, "GPIO pin not set to high");
 }
+
+ZTEST_F(app_led_gpio, test_rgb_gpio_fill_range)
+{
+	rgb_color_t frame[1] = {RGBHEX(Magenta)};
+
+	zassert_equal(app_led_fill_range(fixture->rgb_gpio, 0, 2, RGBHEX(White), K_NO_WAIT),
+		      -EINVAL, "Range past end not rejected");
+
+	zassert_ok(app_led_fill_range(fixture->rgb_gpio, 0, 1, RGBHEX(White), K_NO_WAIT));
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 0), 1, "Red pin not set");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 1), 1, "Green pin not set");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 2), 1, "Blue pin not set");
+
+	zassert_ok(app_led_set_range(fixture->rgb_gpio, 0, frame, ARRAY_SIZE(frame), K_NO_WAIT));
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 0), 1, "Red pin not set");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 1), 0, "Green pin not cleared");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 2), 1, "Blue pin not set");
+}
+
+static uint32_t done_flags;
+static bool done_locked;
+static void test_done_cb(struct app_led_data *leds, uint32_t done, void *user_data)
+{
+	done_flags |= done;
+	done_locked |= leds->mutex.owner == k_current_get();
+}
+
+ZTEST_F(app_led_gpio, test_rgb_gpio_one_write_per_port)
+{
+	uint32_t writes = fixture->rgb_gpio->stats.hw_writes;
+
+	zassert_equal(fixture->rgb_gpio->num_gpio_ports, 1, "RGB pins not grouped by port");
+
+	// all three pins switch with one masked port write
+	zassert_ok(app_led_set_global_color(fixture->rgb_gpio, RGBHEX(White), K_NO_WAIT));
+	zassert_equal(fixture->rgb_gpio->stats.hw_writes, writes + 1, "Not one write per port");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 0), 1, "Red pin not set");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 1), 1, "Green pin not set");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 2), 1, "Blue pin not set");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 3), 0,
+		      "Pin of another instance on the port changed");
+}
+
+ZTEST_F(app_led_gpio, test_rgb_gpio_elides_unchanged_level)
+{
+	struct app_led_stats *stats = &fixture->rgb_gpio->stats;
+	uint32_t writes;
+	uint32_t elided;
+
+	zassert_ok(app_led_set_global_color(fixture->rgb_gpio, RGBHEX(White), K_NO_WAIT));
+	writes = stats->hw_writes;
+	elided = stats->hw_writes_elided;
+
+	// every channel changes value but stays above the GPIO on threshold
+	zassert_ok(app_led_set_global_color(fixture->rgb_gpio, RGBHEX(0xF0F0F0), K_NO_WAIT));
+	zassert_equal(stats->hw_writes, writes, "Unchanged pin level rewritten");
+	zassert_equal(stats->hw_writes_elided, elided + 3, "Elided writes not counted");
+
+	// same frame again is not even compared
+	app_led_update(fixture->rgb_gpio);
+	zassert_equal(stats->hw_writes, writes, "Unchanged frame rewritten");
+
+	// red and green change on the one port so a single write
+	zassert_ok(app_led_set_global_color(fixture->rgb_gpio, RGBHEX(Blue), K_NO_WAIT));
+	zassert_equal(stats->hw_writes, writes + 1, "Changed pins not written");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 0), 0, "Red pin not cleared");
+	zassert_equal(get_gpio_pin_state(fixture->gpio_emul_dev, 2), 1, "Blue pin not set");
+}
+
+ZTEST_F(app_led_gpio, test_update_cycles_recorded)
+{
+	struct app_led_stats *stats = &fixture->rgb_gpio->stats;
+	uint32_t updates = stats->update_count;
+
+	zassert_ok(app_led_set_global_color(fixture->rgb_gpio, RGBHEX(Red), K_NO_WAIT));
+	app_led_update(fixture->rgb_gpio);
+	zassert_true(stats->update_count > updates, "Update not counted");
+	zassert_true(stats->max_update_cycles >= stats->last_update_cycles);
+	// native_sim time only moves on when the CPU idles so a frame takes no cycles there
+	if (!IS_ENABLED(CONFIG_ARCH_POSIX)) {
+		zassert_true(stats->last_update_cycles > 0, "Update cycles not recorded");
+	}
+
+	TC_PRINT("RGB GPIO frame: last %u cycles, max %u cycles (%llu ns)\n",
+		 stats->last_update_cycles, stats->max_update_cycles,
+		 k_cyc_to_ns_floor64(stats->max_update_cycles));
+}
+
+ZTEST_F(app_led_gpio, test_blink_done_callback)
+{
+	done_flags = 0;
+	done_locked = false;
+	app_led_set_done_callback(fixture->gpio, test_done_cb, NULL);
+
+	zassert_ok(app_led_blink(fixture->gpio, RGBHEX(White), 10, 10, true, K_NO_WAIT));
+	zassert_equal(fixture->gpio->mode, Blink, "Not in blink mode");
+
+	// past the off period so update ends blink mode
+	k_sleep(K_MSEC(30));
+	run_update(fixture->gpio);
+
+	zassert_not_equal(fixture->gpio->mode, Blink, "Still in blink mode");
+	zassert_equal(done_flags, APP_LED_DONE_BLINK, "Blink done callback not called");
+	zassert_false(done_locked, "Done callback called with the mutex held");
+
+	app_led_set_done_callback(fixture->gpio, NULL, NULL);
+}
+
+/* A blink takes over the state colour and leaves it black, unless layers keep the base under it */
+ZTEST_F(app_led_gpio, test_blink_state_color)
+{
+	rgb_color_t after = IS_ENABLED(CONFIG_APP_LED_LAYERS) ? RGBHEX(Green) : RGBHEX(Black);
+
+	zassert_ok(app_led_set_index(fixture->rgb_gpio, 0, RGBHEX(Green), K_NO_WAIT));
+	zassert_ok(app_led_blink(fixture->rgb_gpio, RGBHEX(Red), 10, 10, true, K_NO_WAIT));
+
+	// through the off period and out of blink mode
+	k_sleep(K_MSEC(15));
+	run_update(fixture->rgb_gpio);
+	k_sleep(K_MSEC(15));
+	run_update(fixture->rgb_gpio);
+
+	zassert_not_equal(fixture->rgb_gpio->mode, Blink, "Still in blink mode");
+	zassert_equal(fixture->rgb_gpio->state[0].color.hex, after.hex,
+		      "LED colour after the blink");
+}
+
+ZTEST_F(app_led_gpio, test_keyframes_follow_time)
+{
+	static const app_led_keyframe_t fade[] = {
+		{.color = RGBHEX(Black), .brightness = 0xFF, .duration_ms = 100},
+		{.color = RGBHEX(White), .brightness = 0xFF, .duration_ms = APP_LED_KEYFRAME_END},
+	};
+	app_led_sequence_data_t *data = &fixture->rgb_gpio->sequence_data;
+
+	done_flags = 0;
+	app_led_set_done_callback(fixture->rgb_gpio, test_done_cb, NULL);
+	app_led_run_keyframes(fixture->rgb_gpio, fade, 0, K_NO_WAIT);
+	zassert_equal(fixture->rgb_gpio->mode, Sequence, "Not in sequence mode");
+
+	// half way by time however many updates ran
+	k_sleep(K_MSEC(50));
+	app_led_update(fixture->rgb_gpio);
+	zassert_between_inclusive(data->color.r, 0x60, 0xA0, "Not half way: %u", data->color.r);
+
+	// one late update lands on the end rather than taking another step
+	k_sleep(K_MSEC(200));
+	app_led_update(fixture->rgb_gpio);
+	zassert_equal(data->color.hex, RGBHEX(White).hex, "Fade stretched by late update");
+	zassert_not_equal(fixture->rgb_gpio->mode, Sequence, "Sequence did not end");
+	zassert_equal(done_flags, APP_LED_DONE_SEQUENCE, "Sequence done callback not called");
+
+	app_led_set_done_callback(fixture->rgb_gpio, NULL, NULL);
+}
+
+ZTEST_F(app_led_gpio, test_sequence_resumes_after_pause)
+{
+	static const app_led_keyframe_t fade[] = {
+		{.color = RGBHEX(Black), .brightness = 0xFF, .duration_ms = 100},
+		{.color = RGBHEX(White), .brightness = 0xFF, .duration_ms = APP_LED_KEYFRAME_END},
+	};
+	app_led_sequence_data_t *data = &fixture->rgb_gpio->sequence_data;
+
+	app_led_run_keyframes(fixture->rgb_gpio, fade, -1, K_NO_WAIT);
+	app_led_update(fixture->rgb_gpio);
+
+	// not updated for many passes then back to the sequence
+	app_led_set_mode(fixture->rgb_gpio, Manual, K_NO_WAIT);
+	k_sleep(K_MSEC(1000));
+	app_led_set_mode(fixture->rgb_gpio, Sequence, K_NO_WAIT);
+	app_led_update(fixture->rgb_gpio);
+
+	// plays from the resume rather than holding the last keyframe a pass an update
+	k_sleep(K_MSEC(50));
+	app_led_update(fixture->rgb_gpio);
+	zassert_between_inclusive(data->color.r, 0x60, 0xA0, "Not resumed: %u", data->color.r);
+
+	app_led_sequence_clear(fixture->rgb_gpio, K_NO_WAIT);
+}
@@ -0,0 +1,75 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <app_led/led.h>
+
+#include "test_util.h"
+
+#define TEST_SEQUENCE_MS 700
+
+// only built into the sequence_cache scenario
+#if IS_ENABLED(CONFIG_APP_LED_SEQUENCE_CACHE)
+APP_LED_STATIC_DEFINE(cached_led, DT_ALIAS(cache_gpio_leds), 3, 1);
+
+static rgb_color_t cache[APP_LED_SEQUENCE_CACHE_LEN(TEST_SEQUENCE_MS)];
+
+static void *app_led_sequence_cache_setup(void)
+{
+	zassert_ok(app_led_init(&cached_led), "Init failed");
+
+	return NULL;
+}
+
+static void app_led_sequence_cache_before(void *f)
+{
+	app_led_sequence_clear(&cached_led, K_NO_WAIT);
+	app_led_set_mode(&cached_led, Manual, K_NO_WAIT);
+	app_led_set_global_brightness(&cached_led, 0xFF, K_NO_WAIT);
+	zassert_ok(app_led_set_sequence_cache(&cached_led, cache, ARRAY_SIZE(cache), K_NO_WAIT));
+}
+
+ZTEST_SUITE(app_led_sequence_cache, NULL, app_led_sequence_cache_setup,
+	    app_led_sequence_cache_before, NULL, NULL);
+
+ZTEST(app_led_sequence_cache, test_played_from_cache)
+{
+	app_led_run_sequence(&cached_led, app_led_test_sequence, 0, K_NO_WAIT);
+	zassert_equal(cached_led.sequence_cache_len, ARRAY_SIZE(cache), "Sequence not cached");
+	zassert_equal(test_shown(&cached_led), RGBHEX(Red).hex);
+
+	k_sleep(K_MSEC(250));
+	zassert_equal(test_shown(&cached_led), RGBHEX(Green).hex);
+
+	k_sleep(K_MSEC(TEST_SEQUENCE_MS));
+	zassert_equal(test_shown(&cached_led), RGBHEX(Black).hex);
+	zassert_not_equal(cached_led.mode, Sequence, "Cached sequence did not end");
+}
+
+ZTEST(app_led_sequence_cache, test_rendered_again_on_brightness)
+{
+	app_led_run_sequence(&cached_led, app_led_test_sequence, -1, K_NO_WAIT);
+	zassert_equal(test_shown(&cached_led), RGBHEX(Red).hex);
+
+	// steps are clamped to the global brightness
+	zassert_ok(app_led_set_global_brightness(&cached_led, 0x80, K_NO_WAIT));
+	zassert_equal(test_shown(&cached_led), RGB(0x80, 0, 0).hex, "Cache not rendered again");
+	zassert_equal(cached_led.cache_brightness, 0x80);
+}
+
+ZTEST(app_led_sequence_cache, test_not_cached)
+{
+	// too long for the cache so runs live
+	zassert_ok(app_led_set_sequence_cache(&cached_led, cache, 2, K_NO_WAIT));
+	app_led_run_sequence(&cached_led, app_led_test_sequence, 0, K_NO_WAIT);
+	zassert_equal(cached_led.sequence_cache_len, 0);
+	zassert_equal(test_shown(&cached_led), RGBHEX(Red).hex);
+
+	// step functions other than app_led_seq_fnc depend on more than the global colour
+	zassert_ok(app_led_set_sequence_cache(&cached_led, cache, ARRAY_SIZE(cache), K_NO_WAIT));
+	app_led_run_sequence(&cached_led, app_led_chase_sequence, 0, K_NO_WAIT);
+	zassert_equal(cached_led.sequence_cache_len, 0);
+}
+#endif
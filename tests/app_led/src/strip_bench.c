@@ -0,0 +1,182 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/drivers/led_strip.h>
+
+#include <app_led/led.h>
+
+#define BENCH_FRAMES	  100
+#define BENCH_BLINK_MS	  60000
+
+// only built into the strip_bench scenarios, which enable LED_STRIP on the emulated SPI bus
+#if IS_ENABLED(CONFIG_LED_STRIP)
+#if IS_ENABLED(CONFIG_ARCH_POSIX)
+#include "native_rtc.h"
+#endif
+
+#define BENCH_NUM_LEDS DT_PROP(DT_ALIAS(led_strip), chain_length)
+
+APP_LED_STATIC_STRIP_DEFINE(bench_strip, DT_ALIAS(led_strip));
+
+/* Own strips at typical lengths, so effects are timed without overlap or a segment lock */
+APP_LED_STATIC_STRIP_DEFINE(effect_60, DT_ALIAS(effect_60_led_strip));
+APP_LED_STATIC_STRIP_DEFINE(effect_300, DT_ALIAS(effect_300_led_strip));
+APP_LED_STATIC_STRIP_DEFINE(effect_1000, DT_ALIAS(effect_1000_led_strip));
+
+static app_led_data_t *const effect_strips[] = {&effect_60, &effect_300, &effect_1000};
+
+static rgb_color_t gradient[BENCH_NUM_LEDS];
+
+/* native_sim time only moves on when the CPU idles so busy work is timed with the host clock */
+static uint64_t bench_now_us(void)
+{
+#if IS_ENABLED(CONFIG_ARCH_POSIX)
+	return native_rtc_gettime_us(RTC_CLOCK_REAL);
+#else
+	return k_ticks_to_us_floor64(k_uptime_ticks());
+#endif
+}
+
+/* Time frames of one path over the whole of leds; timing varies so it is only reported. Cycles
+ * come from the frame itself, the host clock covers native_sim where the counter stands still
+ */
+static void bench(const char *name, app_led_data_t *leds,
+		  uint32_t (*frame)(app_led_data_t *leds, int n))
+{
+	uint64_t start = bench_now_us();
+	uint64_t cycles = 0;
+	uint64_t us;
+
+	for (int n = 0; n < BENCH_FRAMES; n++) {
+		cycles += frame(leds, n);
+	}
+	us = (bench_now_us() - start) / BENCH_FRAMES;
+	cycles /= BENCH_FRAMES;
+
+	TC_PRINT("%-10s %4u px: %llu cycles/frame, %llu us/frame, %llu ns/px\n", name,
+		 leds->num_leds, cycles, us, us * NSEC_PER_USEC / leds->num_leds);
+}
+
+static uint32_t fill_frame(app_led_data_t *leds, int n)
+{
+	uint32_t start = k_cycle_get_32();
+
+	zassert_ok(app_led_fill_range(leds, 0, leds->num_leds, (n & 1) ? RGBHEX(Red) : RGBHEX(Blue),
+				      K_FOREVER));
+	return k_cycle_get_32() - start;
+}
+
+static uint32_t range_frame(app_led_data_t *leds, int n)
+{
+	uint32_t start = k_cycle_get_32();
+
+	zassert_ok(app_led_set_range(leds, 0, gradient, leds->num_leds, K_FOREVER));
+	return k_cycle_get_32() - start;
+}
+
+static uint32_t update_frame(app_led_data_t *leds, int n)
+{
+	app_led_update(leds);
+	return leds->stats.last_update_cycles;
+}
+
+static void *app_led_strip_bench_setup(void)
+{
+	zassert_ok(app_led_init(&bench_strip), "Init failed");
+	for (int i = 0; i < ARRAY_SIZE(effect_strips); i++) {
+		zassert_ok(app_led_init(effect_strips[i]), "Init failed");
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(gradient); i++) {
+		gradient[i] = app_led_hue_to_rgb((uint8_t)i);
+	}
+
+	TC_PRINT("%u px, %u bytes per pixel\n", bench_strip.num_leds,
+		 (unsigned int)(sizeof(struct app_led_state) + 2 * sizeof(struct led_rgb) +
+				(IS_ENABLED(CONFIG_APP_LED_BLINK) ? sizeof(struct app_led_blink) : 0)));
+
+	return NULL;
+}
+
+static void app_led_strip_bench_after(void *f)
+{
+	app_led_sequence_clear(&bench_strip, K_FOREVER);
+	app_led_blink_sync(&bench_strip, RGBHEX(Black), K_FOREVER);
+	app_led_set_mode(&bench_strip, Manual, K_FOREVER);
+	app_led_set_global_color(&bench_strip, RGBHEX(Black), K_FOREVER);
+}
+
+ZTEST_SUITE(app_led_strip_bench, NULL, app_led_strip_bench_setup, NULL, app_led_strip_bench_after,
+	    NULL);
+
+ZTEST(app_led_strip_bench, test_index_past_255)
+{
+	uint16_t last = bench_strip.num_leds - 1;
+	rgb_color_t c;
+
+	zassert_true(bench_strip.num_leds > UINT8_MAX, "Bench strip too short");
+	zassert_equal(bench_strip.num_leds, BENCH_NUM_LEDS);
+
+	zassert_ok(app_led_set_index(&bench_strip, last, RGBHEX(Green), K_FOREVER));
+	zassert_ok(app_led_get_pixel_rgb(&bench_strip, last, &c));
+	zassert_equal(c.hex, RGBHEX(Green).hex, "Last pixel not set");
+	zassert_ok(app_led_get_pixel_rgb(&bench_strip, last - 256, &c));
+	zassert_equal(c.hex, RGBHEX(Black).hex, "Index wrapped at 256");
+	zassert_equal(app_led_set_index(&bench_strip, bench_strip.num_leds, RGBHEX(Green),
+					K_FOREVER),
+		      -EINVAL);
+}
+
+ZTEST(app_led_strip_bench, test_bench_fill)
+{
+	bench("fill", &bench_strip, fill_frame);
+	bench("range", &bench_strip, range_frame);
+}
+
+ZTEST(app_led_strip_bench, test_bench_blink)
+{
+	rgb_color_t c;
+
+	zassert_ok(app_led_blink(&bench_strip, RGBHEX(White), BENCH_BLINK_MS, BENCH_BLINK_MS, true,
+				 K_FOREVER));
+	zassert_equal(bench_strip.mode, Blink);
+
+	bench("blink", &bench_strip, update_frame);
+	zassert_ok(app_led_get_pixel_rgb(&bench_strip, bench_strip.num_leds - 1, &c));
+	zassert_equal(c.hex, RGBHEX(White).hex, "Blink not rendered to the end of the strip");
+}
+
+ZTEST(app_led_strip_bench, test_bench_sequences)
+{
+	// chase and sine fade every pixel each frame
+	app_led_run_sequence(&bench_strip, app_led_chase_sequence, -1, K_FOREVER);
+	bench("chase", &bench_strip, update_frame);
+
+	app_led_run_sequence(&bench_strip, app_led_sine_sequence, -1, K_FOREVER);
+	bench("sine", &bench_strip, update_frame);
+}
+
+ZTEST(app_led_strip_bench, test_bench_effects)
+{
+	static const struct {
+		const char *name;
+		const app_led_sequence_step_t *sequence;
+	} effects[] = {
+		{"chase", app_led_chase_sequence},
+		{"fade_blink", app_led_fade_blink_sequence},
+		{"half_blink", app_led_half_blink_sequence},
+		{"sine", app_led_sine_sequence},
+	};
+
+	// every effect fades the whole frame each update, so time is per pixel at any length
+	for (int e = 0; e < ARRAY_SIZE(effects); e++) {
+		for (int i = 0; i < ARRAY_SIZE(effect_strips); i++) {
+			app_led_run_sequence(effect_strips[i], effects[e].sequence, -1, K_FOREVER);
+			bench(effects[e].name, effect_strips[i], update_frame);
+			app_led_sequence_clear(effect_strips[i], K_FOREVER);
+		}
+	}
+}
+#endif
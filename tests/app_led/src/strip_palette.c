@@ -0,0 +1,122 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/drivers/led_strip.h>
+
+#include <app_led/led.h>
+
+#define ROTATE_FRAMES 100
+
+// only built into the strip_bench scenarios, which enable the palette on the emulated SPI strip
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_PALETTE)
+APP_LED_STATIC_STRIP_PALETTE_DEFINE(palette_strip, DT_ALIAS(led_strip));
+APP_LED_STATIC_DEFINE(plain_led, DT_ALIAS(gpio_leds), 1, 0); // never initialized
+
+static const rgb_color_t stripes[] = {RGBHEX(Red), RGBHEX(Green), RGBHEX(Blue)};
+
+static void *app_led_strip_palette_setup(void)
+{
+	zassert_ok(app_led_init(&palette_strip), "Init failed");
+
+	TC_PRINT("%u px, %u index bits: %u frame bytes vs %u for a led_rgb back buffer\n",
+		 palette_strip.num_leds, CONFIG_APP_LED_STRIP_PALETTE_BITS,
+		 (unsigned int)APP_LED_PALETTE_FRAME_SIZE(palette_strip.hw_num_leds),
+		 (unsigned int)(palette_strip.hw_num_leds * sizeof(struct led_rgb)));
+
+	return NULL;
+}
+
+ZTEST_SUITE(app_led_strip_palette, NULL, app_led_strip_palette_setup, NULL, NULL, NULL);
+
+ZTEST(app_led_strip_palette, test_not_palette_strip)
+{
+	zassert_equal(app_led_palette_rotate(&plain_led, 0, 2, K_NO_WAIT), -ENOTSUP);
+}
+
+ZTEST(app_led_strip_palette, test_fill_and_rotate)
+{
+	uint16_t third = palette_strip.num_leds / 3;
+	rgb_color_t c;
+
+	zassert_ok(app_led_palette_set(&palette_strip, 0, stripes, ARRAY_SIZE(stripes), K_NO_WAIT));
+	for (int s = 0; s < ARRAY_SIZE(stripes); s++) {
+		zassert_ok(app_led_fill_palette_range(&palette_strip, s * third, third, s, K_NO_WAIT));
+	}
+	zassert_ok(app_led_get_pixel_rgb(&palette_strip, third, &c));
+	zassert_equal(c.hex, RGBHEX(Green).hex);
+
+	// pixels keep their index, the colour behind it moves
+	zassert_ok(app_led_palette_rotate(&palette_strip, 0, ARRAY_SIZE(stripes), K_NO_WAIT));
+	zassert_ok(app_led_get_pixel_rgb(&palette_strip, 0, &c));
+	zassert_equal(c.hex, RGBHEX(Green).hex, "Palette not rotated");
+	zassert_ok(app_led_get_pixel_rgb(&palette_strip, 2 * third, &c));
+	zassert_equal(c.hex, RGBHEX(Red).hex, "Palette not rotated");
+	zassert_equal(palette_strip.dirty_end, palette_strip.hw_num_leds,
+		      "Rotation should expand the whole strip at the next flush");
+
+	zassert_equal(app_led_fill_palette_range(&palette_strip, 0, 1, palette_strip.palette_len,
+						 K_NO_WAIT),
+		      -EINVAL, "Unused palette entry accepted");
+}
+
+ZTEST(app_led_strip_palette, test_colours_added_to_palette)
+{
+	uint16_t len;
+	rgb_color_t c;
+
+	zassert_ok(app_led_fill_range(&palette_strip, 0, palette_strip.num_leds, RGBHEX(Black),
+				      K_NO_WAIT));
+	zassert_ok(app_led_set_index(&palette_strip, 10, RGBHEX(Orange), K_NO_WAIT));
+	len = palette_strip.palette_len;
+	zassert_ok(app_led_set_index(&palette_strip, 11, RGBHEX(Orange), K_NO_WAIT));
+	zassert_equal(palette_strip.palette_len, len, "Existing colour added again");
+	zassert_ok(app_led_get_pixel_rgb(&palette_strip, 11, &c));
+	zassert_equal(c.hex, RGBHEX(Orange).hex);
+
+	// more distinct colours than entries: unused ones are reclaimed, then nearest is used
+	for (int i = 0; i < APP_LED_PALETTE_SIZE * 2; i++) {
+		zassert_ok(app_led_set_index(&palette_strip, i, RGB(i, 0, 0), K_NO_WAIT));
+	}
+	zassert_true(palette_strip.palette_len <= APP_LED_PALETTE_SIZE);
+	zassert_ok(app_led_get_pixel_rgb(&palette_strip, 0, &c));
+	zassert_equal(c.hex, RGB(0, 0, 0).hex);
+}
+
+ZTEST(app_led_strip_palette, test_brightness_reuses_entries)
+{
+	uint16_t len;
+	rgb_color_t c;
+
+	zassert_ok(app_led_set_global_color(&palette_strip, RGBHEX(Orange), K_NO_WAIT));
+	len = palette_strip.palette_len;
+
+	// brightness is applied to the palette at flush, so fade steps don't each add an entry
+	for (int b = 0xFF; b > 0; b -= 0x11) {
+		zassert_ok(app_led_set_global_brightness(&palette_strip, b, K_NO_WAIT));
+	}
+	zassert_equal(palette_strip.palette_len, len, "Brightness steps added palette entries");
+	zassert_ok(app_led_get_pixel_rgb(&palette_strip, 0, &c));
+	zassert_equal(c.hex, app_led_scale_color(&palette_strip, RGBHEX(Orange), 0x11).hex);
+
+	zassert_ok(app_led_set_global_brightness(&palette_strip, 0xFF, K_NO_WAIT));
+	zassert_ok(app_led_set_global_color(&palette_strip, RGBHEX(Black), K_NO_WAIT));
+}
+
+ZTEST(app_led_strip_palette, test_bench_rotate)
+{
+	uint32_t start;
+	uint32_t cycles;
+
+	zassert_ok(app_led_palette_set(&palette_strip, 0, stripes, ARRAY_SIZE(stripes), K_NO_WAIT));
+
+	start = k_cycle_get_32();
+	for (int n = 0; n < ROTATE_FRAMES; n++) {
+		zassert_ok(app_led_palette_rotate(&palette_strip, 0, ARRAY_SIZE(stripes), K_NO_WAIT));
+	}
+	cycles = (k_cycle_get_32() - start) / ROTATE_FRAMES;
+
+	TC_PRINT("palette rotate %u px: %u cycles per rotation\n", palette_strip.num_leds, cycles);
+}
+#endif
@@ -0,0 +1,83 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/drivers/led_strip.h>
+
+#include <app_led/led.h>
+
+// only built into the strip_bench scenarios, which enable segments on the emulated SPI strip
+#if IS_ENABLED(CONFIG_APP_LED_STRIP_SEGMENTS)
+#define SEGMENT_LEN 100
+
+APP_LED_STRIP_SHARED_DEFINE(shared_strip, DT_ALIAS(led_strip));
+APP_LED_STATIC_STRIP_SEGMENT_DEFINE(seg_head, shared_strip, DT_ALIAS(led_strip), 0, SEGMENT_LEN);
+APP_LED_STATIC_STRIP_SEGMENT_DEFINE(seg_tail, shared_strip, DT_ALIAS(led_strip),
+				    DT_PROP(DT_ALIAS(led_strip), chain_length) - SEGMENT_LEN,
+				    SEGMENT_LEN);
+
+/* Pixel of the shared back buffer the views render into */
+static const struct led_rgb *shared_pixel(uint16_t i)
+{
+	return (const struct led_rgb *)shared_strip.pixels[!atomic_get(&shared_strip.front)] + i;
+}
+
+static void *app_led_strip_segments_setup(void)
+{
+	zassert_ok(app_led_init(&seg_head), "Init failed");
+	zassert_ok(app_led_init(&seg_tail), "Init failed");
+
+	return NULL;
+}
+
+static void app_led_strip_segments_before(void *f)
+{
+	app_led_set_mode(&seg_head, Manual, K_FOREVER);
+	app_led_set_mode(&seg_tail, Manual, K_FOREVER);
+	app_led_fill_range(&seg_head, 0, SEGMENT_LEN, RGBHEX(Black), K_FOREVER);
+	app_led_fill_range(&seg_tail, 0, SEGMENT_LEN, RGBHEX(Black), K_FOREVER);
+	zassert_ok(app_led_strip_flush(&shared_strip));
+}
+
+ZTEST_SUITE(app_led_strip_segments, NULL, app_led_strip_segments_setup,
+	    app_led_strip_segments_before, NULL, NULL);
+
+ZTEST(app_led_strip_segments, test_views_at_offset)
+{
+	uint16_t tail_start = shared_strip.num_leds - SEGMENT_LEN;
+	rgb_color_t c;
+
+	zassert_equal(seg_tail.num_leds, SEGMENT_LEN);
+	zassert_ok(app_led_set_index(&seg_tail, 0, RGBHEX(Red), K_FOREVER));
+	zassert_ok(app_led_get_pixel_rgb(&seg_tail, 0, &c));
+	zassert_equal(c.hex, RGBHEX(Red).hex);
+	zassert_equal(shared_pixel(tail_start)->r, 0xFF, "View not rendered at its offset");
+	zassert_equal(shared_pixel(0)->r, 0, "View rendered into another");
+
+	zassert_equal(app_led_set_index(&seg_head, SEGMENT_LEN, RGBHEX(Red), K_FOREVER), -EINVAL,
+		      "Index past the view accepted");
+}
+
+ZTEST(app_led_strip_segments, test_one_flush_for_all_views)
+{
+	uint32_t flushes = shared_strip.flushes;
+	uint32_t skipped = shared_strip.skipped_flushes;
+
+	// each view runs its own mode, both changes go out in one transfer
+	zassert_ok(app_led_blink(&seg_head, RGBHEX(Blue), 1000, 1000, true, K_FOREVER));
+	zassert_ok(app_led_fill_range(&seg_tail, 0, SEGMENT_LEN, RGBHEX(Green), K_FOREVER));
+	app_led_update(&seg_head);
+	app_led_update(&seg_tail);
+
+	zassert_equal(shared_strip.dirty_start, 0);
+	zassert_equal(shared_strip.dirty_end, shared_strip.num_leds);
+	zassert_ok(app_led_strip_flush(&shared_strip));
+	zassert_equal(shared_strip.flushes, flushes + 1, "Views not flushed together");
+
+	zassert_ok(app_led_strip_flush(&shared_strip));
+	zassert_equal(shared_strip.skipped_flushes, skipped + 1, "Unchanged strip flushed again");
+	zassert_equal(seg_head.mode, Blink);
+	zassert_equal(seg_tail.mode, Manual);
+}
+#endif
@@ -0,0 +1,19 @@
+#ifndef APP_LED_TEST_UTIL_H_
+#define APP_LED_TEST_UTIL_H_
+
+/* Helpers shared by the test suites; include after app_led/led.h */
+
+#include <zephyr/ztest.h>
+
+/* Colour of the first LED once leds has updated, composited if layers are enabled */
+static inline uint32_t test_shown(app_led_data_t *leds)
+{
+	rgb_color_t c;
+
+	app_led_update(leds);
+	zassert_ok(app_led_get_pixel_rgb(leds, 0, &c));
+
+	return c.hex;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <app_led/led.h>
+
+#define SLEEPER_MS 5000
+#define SETTLE_MS  (CONFIG_APP_LED_UPDATE_PERIOD * 3)
+
+// only built into the workqueue scenario, which updates from the background work
+#if IS_ENABLED(CONFIG_APP_LED_USE_WORKQUEUE) && IS_ENABLED(CONFIG_LED_STRIP)
+APP_LED_STATIC_DEFINE(wq_sleeper, DT_ALIAS(wq_gpio_leds), 1, 0);
+APP_LED_STATIC_STRIP_DEFINE(wq_strip, DT_ALIAS(wq_led_strip));
+
+static void *app_led_workqueue_setup(void)
+{
+	zassert_ok(app_led_init(&wq_sleeper), "Init failed");
+	zassert_ok(app_led_init(&wq_strip), "Init failed");
+
+	return NULL;
+}
+
+static void app_led_workqueue_before(void *f)
+{
+	app_led_set_mode(&wq_sleeper, Manual, K_FOREVER);
+	app_led_set_mode(&wq_strip, Manual, K_FOREVER);
+	k_sleep(K_MSEC(SETTLE_MS));
+}
+
+ZTEST_SUITE(app_led_workqueue, NULL, app_led_workqueue_setup, app_led_workqueue_before, NULL,
+	    NULL);
+
+ZTEST(app_led_workqueue, test_manual_write_flushed_promptly)
+{
+	uint32_t flushes;
+
+	// a long blink leaves the work pending for an edge seconds away when tickless
+	zassert_ok(app_led_blink(&wq_sleeper, RGBHEX(White), SLEEPER_MS, SLEEPER_MS, true,
+				 K_FOREVER));
+	k_sleep(K_MSEC(SETTLE_MS));
+	flushes = wq_strip.stats.flushes;
+
+	zassert_ok(app_led_set_index(&wq_strip, 0, RGBHEX(Red), K_FOREVER));
+	k_sleep(K_MSEC(SETTLE_MS));
+	zassert_true(wq_strip.stats.flushes > flushes, "Manual write held off by a later deadline");
+}
+
+ZTEST(app_led_workqueue, test_blink_runs_in_background)
+{
+	zassert_ok(app_led_blink(&wq_sleeper, RGBHEX(White), 20, 20, true, K_FOREVER));
+	zassert_equal(wq_sleeper.mode, Blink);
+
+	// no app_led_update here, the work ends the blink and reports it
+	k_sleep(K_MSEC(20 * 2 + SETTLE_MS));
+	zassert_not_equal(wq_sleeper.mode, Blink, "Blink not run by the work");
+}
+#endif